@@ -0,0 +1,76 @@
+#ifndef AGENT_LEDGER_HPP
+#define AGENT_LEDGER_HPP
+
+#include "LimitOrderBook.hpp"
+#include "MemoryAccounting.hpp"
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+// Order matches the SENTIMENT message: fundamental, momentum, maker, noise, user.
+enum class AgentClass : uint8_t { FUNDAMENTAL = 0, MOMENTUM = 1, MAKER = 2, NOISE = 3, USER = 4 };
+constexpr int NUM_AGENT_CLASSES = 5;
+
+struct LedgerEntry { uint32_t account; AgentClass cls; double pnl; };
+
+// Per-agent inventory and P&L, one slot per account, stored as parallel arrays so
+// fills touch a few contiguous cache lines and leaderboard scans stream.
+// Everyone starts flat with zero cash; average-cost accounting splits P&L into
+// realized and unrealized, and realized + unrealized == cash + position * mark.
+class AgentLedger {
+public:
+    std::vector<int64_t> position;
+    std::vector<double> cash, avg_price, realized;
+    std::vector<AgentClass> cls;
+
+    uint32_t add_account(AgentClass c) {
+        position.push_back(0); cash.push_back(0.0); avg_price.push_back(0.0); realized.push_back(0.0); cls.push_back(c);
+        return (uint32_t)(position.size() - 1);
+    }
+    size_t size() const { return position.size(); }
+    size_t memory_bytes() const { return vector_bytes(position) + vector_bytes(cash) + vector_bytes(avg_price) + vector_bytes(realized) + vector_bytes(cls); }
+
+    void on_fill(const Trade& t) { apply(t.buyer, (int64_t)t.quantity, t.price); apply(t.seller, -(int64_t)t.quantity, t.price); }
+
+    double unrealized(uint32_t a, double mark) const { return position[a] * (mark - avg_price[a]); }
+    double pnl(uint32_t a, double mark) const { return cash[a] + position[a] * mark; }
+
+    std::array<double, NUM_AGENT_CLASSES> class_pnl(double mark) const {
+        std::array<double, NUM_AGENT_CLASSES> out{};
+        for (int c = 0; c < NUM_AGENT_CLASSES; ++c) out[c] = class_cash[c] + class_position[c] * mark;
+        return out;
+    }
+
+    // N best (or worst) accounts by total P&L at `mark`; one linear pass plus a partial sort of N.
+    std::vector<LedgerEntry> leaderboard(size_t n, double mark, bool best = true) const {
+        std::vector<LedgerEntry> all; all.reserve(size());
+        for (uint32_t a = 0; a < size(); ++a) all.push_back({a, cls[a], pnl(a, mark)});
+        n = std::min(n, all.size());
+        auto cmp = [best](const LedgerEntry& x, const LedgerEntry& y) { return best ? x.pnl > y.pnl : x.pnl < y.pnl; };
+        std::partial_sort(all.begin(), all.begin() + n, all.end(), cmp);
+        all.resize(n);
+        return all;
+    }
+
+private:
+    std::array<int64_t, NUM_AGENT_CLASSES> class_position{};
+    std::array<double, NUM_AGENT_CLASSES> class_cash{};
+
+    void apply(uint32_t a, int64_t dq, double price) {
+        int64_t pos = position[a];
+        if (pos == 0 || (pos > 0) == (dq > 0)) {
+            avg_price[a] = (avg_price[a] * std::llabs(pos) + price * std::llabs(dq)) / (double)(std::llabs(pos) + std::llabs(dq));
+        } else {
+            int64_t closed = std::min(std::llabs(dq), std::llabs(pos));
+            realized[a] += closed * (price - avg_price[a]) * (pos > 0 ? 1.0 : -1.0);
+            if (std::llabs(dq) > std::llabs(pos)) avg_price[a] = price;
+            else if (pos + dq == 0) avg_price[a] = 0.0;
+        }
+        position[a] = pos + dq;
+        cash[a] -= dq * price;
+        int c = (int)cls[a]; class_position[c] += dq; class_cash[c] -= dq * price;
+    }
+};
+#endif
@@ -0,0 +1,207 @@
+#include "MarketSimulation.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmark regression gate: order book microbenchmarks plus seeded headless simulation
+// ticks per scenario, each repeated and summarized by median and MAD, compared against a
+// committed JSON baseline.
+//   bench_gate [--baseline bench_baseline.json] [--write] [--repeats R] [--ticks T] [--tolerance F]
+// A benchmark regresses when its median exceeds the baseline median by more than both the
+// relative tolerance (default 15%) and 3 standard errors of the difference of medians, each
+// estimated robustly as 1.2533 * 1.4826 * MAD / sqrt(repeats). Exit status 1 on any
+// regression, 2 on usage errors, so `make bench_check` can gate a build.
+// --write records the current run as the new baseline. Workloads are seeded, so every run
+// measures the same order flow; run with the SIM_* feature variables unset.
+
+struct Result { double median, mad; std::string unit; };
+
+struct Options {
+    std::string baseline = "bench_baseline.json";
+    bool write = false; int repeats = 7, ticks = 1000; double tolerance = 0.15;
+};
+
+using Clock = std::chrono::steady_clock;
+static double seconds_since(Clock::time_point t0) { return std::chrono::duration<double>(Clock::now() - t0).count(); }
+
+static Result summarize(std::vector<double> xs, const char* unit) {
+    auto median = [](std::vector<double> v) { std::sort(v.begin(), v.end()); size_t n = v.size(); return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]); };
+    double m = median(xs);
+    for (auto& x : xs) x = std::abs(x - m);
+    return {m, median(xs), unit};
+}
+
+// ---- Book microbenchmarks (ns per operation) ----
+
+static std::vector<Order> random_orders(size_t n, double center, double width, Side side, uint64_t first_id, unsigned seed) {
+    std::mt19937 gen(seed); std::uniform_real_distribution<> px(-width, width); std::uniform_int_distribution<> qty(100, 500);
+    std::vector<Order> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = Order{first_id + i, (double)i, std::round((center + px(gen)) * 100) / 100, (uint32_t)qty(gen), side, 0};
+    return v;
+}
+
+static double bench_add(size_t n) {
+    auto bids = random_orders(n / 2, 99.0, 0.9, Side::BUY, 1, 1), asks = random_orders(n / 2, 101.0, 0.9, Side::SELL, n, 2);
+    LimitOrderBook book;
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < n / 2; ++i) { book.add_order(bids[i]); book.add_order(asks[i]); }
+    return seconds_since(t0) * 1e9 / n;
+}
+
+static double bench_load(size_t n) {
+    auto orders = random_orders(n / 2, 99.0, 0.9, Side::BUY, 1, 1), asks = random_orders(n / 2, 101.0, 0.9, Side::SELL, n, 2);
+    orders.insert(orders.end(), asks.begin(), asks.end());
+    LimitOrderBook book;
+    auto t0 = Clock::now();
+    book.load(orders);
+    return seconds_since(t0) * 1e9 / n;
+}
+
+static double bench_match(size_t n) {
+    auto asks = random_orders(n, 101.0, 1.0, Side::SELL, 1, 3), buys = random_orders(n, 102.5, 0.5, Side::BUY, n + 1, 4);
+    LimitOrderBook book; for (auto& o : asks) book.add_order(o);
+    size_t trades = 0;
+    auto t0 = Clock::now();
+    for (auto& o : buys) trades += book.add_order(o).size();
+    double s = seconds_since(t0);
+    if (!trades) std::cerr << "bench_match: no trades" << std::endl;
+    return s * 1e9 / n;
+}
+
+static double bench_cancel(size_t n) {
+    auto bids = random_orders(n, 99.0, 1.0, Side::BUY, 1, 5);
+    LimitOrderBook book; for (auto& o : bids) book.add_order(o);
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < n; i += 2) book.cancel(bids[i].id);
+    for (size_t i = 0; i < n / 2; ++i) { book.get_metrics(); book.cancel(book.bidHeap.top().id); }
+    return seconds_since(t0) * 1e9 / n;
+}
+
+static double bench_decay(size_t n) {
+    auto bids = random_orders(n, 99.0, 1.0, Side::BUY, 1, 6);
+    LimitOrderBook book; for (auto& o : bids) book.add_order(o);
+    std::mt19937 gen(7);
+    auto t0 = Clock::now();
+    for (int k = 0; k < 10; ++k) book.decay(0.05, gen);
+    return seconds_since(t0) * 1e9 / (10.0 * n);
+}
+
+// ---- Simulation benchmark (us per tick, default population, warm-started book) ----
+
+struct NullSink {
+    void recordTick(double, double, uint64_t) {}
+    void broadcastMetrics(double, long) {}
+    void broadcastFill(const UserFill&) {}
+    void broadcastData(double, uint32_t) {}
+    void broadcastSentiment(long, long, long, long, long, long, long, long, long, long) {}
+    void broadcastScenarioMetrics(double, double, long, double) {}
+    void broadcastPnl(const std::array<double, NUM_AGENT_CLASSES>&, const std::vector<LedgerEntry>&) {}
+    void broadcastAccount(const AccountSnapshot&) {}
+};
+
+static double bench_sim(MarketScenario s, int ticks) {
+    SeedSource rd(42); MarketSimulation sim(SimConfig{200, 200, 175, 350}, rd);
+    sim.set_phase(s); sim.warm_start(2500, 7);
+    NullSink out; std::vector<UserOrder> none;
+    auto t0 = Clock::now();
+    for (int t = 0; t < ticks; ++t) sim.step(none, out);
+    return seconds_since(t0) * 1e6 / ticks;
+}
+
+// ---- Baseline file: one benchmark per line, so diffs of the committed file stay readable ----
+
+static bool load(const std::string& path, std::map<std::string, Result>& out, int& repeats) {
+    std::ifstream in(path); if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (size_t r = line.find("\"repeats\":"); r != std::string::npos) repeats = std::max(1, std::atoi(line.c_str() + r + 10));
+        size_t q0 = line.find('"'), q1 = line.find('"', q0 + 1), m = line.find("\"median\":"), d = line.find("\"mad\":"), u = line.find("\"unit\": \"");
+        if (q0 == std::string::npos || q1 == std::string::npos || m == std::string::npos || d == std::string::npos) continue;
+        Result r{std::atof(line.c_str() + m + 9), std::atof(line.c_str() + d + 6), ""};
+        if (u != std::string::npos) r.unit = line.substr(u + 9, line.find('"', u + 9) - u - 9);
+        out[line.substr(q0 + 1, q1 - q0 - 1)] = r;
+    }
+    return true;
+}
+
+static void save(const std::string& path, const std::vector<std::pair<std::string, Result>>& results, const Options& opt) {
+    std::ofstream f(path);
+    f << "{\n  \"repeats\": " << opt.repeats << ", \"ticks\": " << opt.ticks << ",\n  \"benchmarks\": {\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        char buf[256]; const Result& r = results[i].second;
+        std::snprintf(buf, sizeof(buf), "    \"%s\": {\"median\": %.3f, \"mad\": %.3f, \"unit\": \"%s\"}%s\n", results[i].first.c_str(), r.median, r.mad, r.unit.c_str(), i + 1 < results.size() ? "," : "");
+        f << buf;
+    }
+    f << "  }\n}\n";
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string k = argv[i];
+        if (k == "--write") { opt.write = true; continue; }
+        if (i + 1 >= argc) { std::cerr << "missing value for " << k << std::endl; return 2; }
+        const char* v = argv[++i];
+        if (k == "--baseline") opt.baseline = v;
+        else if (k == "--repeats") opt.repeats = std::max(1, std::atoi(v));
+        else if (k == "--ticks") opt.ticks = std::max(1, std::atoi(v));
+        else if (k == "--tolerance") opt.tolerance = std::atof(v);
+        else { std::cerr << "unknown option " << k << std::endl; return 2; }
+    }
+    for (const char* var : {"SIM_KERNEL", "SIM_HAWKES", "SIM_LATENCY", "SIM_NOISE_CROWD", "SIM_TIMELINE", "SIM_PUBLISH_EVERY", "SIM_TRACE", "SIM_PERF", "SIM_WARM_START"})
+        if (std::getenv(var)) std::cerr << "bench_gate: warning: " << var << " is set and changes the measured workload" << std::endl;
+
+    std::map<std::string, Result> base; int base_repeats = 1;
+    if (!opt.write && !load(opt.baseline, base, base_repeats)) { std::cerr << "bench_gate: no baseline at " << opt.baseline << " (create one with --write)" << std::endl; return 2; }
+
+    const size_t N = 200000;
+    std::vector<std::pair<std::string, std::function<double()>>> benches = {
+        {"book.add_resting", [&] { return bench_add(N); }},
+        {"book.bulk_load", [&] { return bench_load(N); }},
+        {"book.match", [&] { return bench_match(N); }},
+        {"book.cancel_clean", [&] { return bench_cancel(N); }},
+        {"book.decay", [&] { return bench_decay(N); }},
+        {"sim.normal", [&] { return bench_sim(MarketScenario::NORMAL, opt.ticks); }},
+        {"sim.pump_dump", [&] { return bench_sim(MarketScenario::PUMP_DUMP, opt.ticks); }},
+        {"sim.short_squeeze", [&] { return bench_sim(MarketScenario::SHORT_SQUEEZE, opt.ticks); }},
+    };
+
+    // Interleave repeats across benchmarks so slow drift (thermal, neighbours) hits all alike
+    std::vector<std::vector<double>> samples(benches.size());
+    for (int r = 0; r < opt.repeats; ++r) for (size_t b = 0; b < benches.size(); ++b) samples[b].push_back(benches[b].second());
+    std::vector<std::pair<std::string, Result>> results;
+    for (size_t b = 0; b < benches.size(); ++b) results.push_back({benches[b].first, summarize(samples[b], benches[b].first.rfind("sim.", 0) == 0 ? "us/tick" : "ns/op")});
+
+    if (opt.write) {
+        save(opt.baseline, results, opt);
+        for (auto& [name, r] : results) std::printf("%-20s %10.3f %s (MAD %.3f)\n", name.c_str(), r.median, r.unit.c_str(), r.mad);
+        std::printf("Wrote baseline %s\n", opt.baseline.c_str());
+        return 0;
+    }
+
+    auto stderr_of_median = [](double mad, int n) { return 1.2533 * 1.4826 * mad / std::sqrt((double)n); };
+    int regressions = 0;
+    std::printf("%-20s %12s %12s %8s %10s  %s\n", "benchmark", "baseline", "current", "change", "threshold", "verdict");
+    for (auto& [name, r] : results) {
+        auto it = base.find(name);
+        if (it == base.end()) { std::printf("%-20s %12s %12.3f %8s %10s  new (not in baseline)\n", name.c_str(), "-", r.median, "-", "-"); continue; }
+        const Result& b = it->second;
+        double sigma = std::hypot(stderr_of_median(b.mad, base_repeats), stderr_of_median(r.mad, opt.repeats));
+        double allowed = std::max(opt.tolerance * b.median, 3.0 * sigma), delta = r.median - b.median;
+        bool slower = delta > allowed, faster = -delta > allowed;
+        regressions += slower;
+        std::printf("%-20s %12.3f %12.3f %+7.1f%% %+9.1f%%  %s\n", name.c_str(), b.median, r.median, 100.0 * delta / b.median, 100.0 * allowed / b.median,
+            slower ? "REGRESSION" : faster ? "faster" : "ok");
+    }
+    std::printf("%d regression%s (median of %d repeats vs baseline %s)\n", regressions, regressions == 1 ? "" : "s", opt.repeats, opt.baseline.c_str());
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+#include "MarketSimulation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fits scenario params (ScenarioParams) of the very volatile engine to target market statistics.
+//   calibrate [--vol V] [--spread S] [--volume Q] [--params p1,p2,...] [--scenario N]
+//             [--config "makers fund mom noise"] [--ticks T] [--warmup W] [--seeds K] [--seed S]
+//             [--iters N] [--threads T] [--out fitted.txt]
+// Targets: daily volatility of log returns (tick stdev * sqrt(390 ticks per day)), mean relative
+// top-of-book spread (spread / price), and traded volume per day; any subset. Each candidate
+// runs K seeded simulations in-process, the same K seeds for every candidate (common random
+// numbers), with statistics accumulated as the run streams. The loss is the sum of squared log
+// ratios to the targets, minimized by Nelder-Mead over log (or logit, for probabilities) params;
+// each iteration evaluates reflection, expansion and both contractions in one parallel batch.
+// The result is a timeline file for SIM_TIMELINE: "0 phase <S>" then one "0 set" per param.
+
+static constexpr double TICKS_PER_DAY = 6.5 * 60 * 60 / MarketSimulation::dt;
+
+struct Param { std::string name; double ScenarioParams::* field; bool prob; };
+struct Stats { double vol = 0, spread = 0, volume = 0; };
+
+struct Options {
+    double vol = NAN, spread = NAN, volume = NAN;
+    std::vector<std::string> params{"maker_spread_mult", "noise_wake_speed", "fund_wake_mean"};
+    MarketScenario scenario = MarketScenario::NORMAL;
+    SimConfig config{200, 200, 175, 350};
+    int ticks = 2000, warmup = 200, seeds = 4, iters = 40;
+    unsigned int seed = 42;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string out = "calibrated.txt";
+};
+
+// Sink accumulating the target statistics tick by tick (Welford for return variance)
+struct StatsSink {
+    long skip; double last = 0; long n = 0; double mean = 0, m2 = 0, volume = 0, spread_sum = 0; long spreads = 0;
+
+    explicit StatsSink(long warmup) : skip(warmup) {}
+    void recordTick(double, double price, uint64_t v) {
+        if (skip > 0 || last <= 0) { --skip; last = price; return; }
+        double r = std::log(price / last), d = r - mean; last = price;
+        mean += d / ++n; m2 += d * (r - mean); volume += v;
+    }
+    void broadcastMetrics(double spread, long) { if (skip <= 0 && spread > 0 && last > 0) { spread_sum += spread / last; ++spreads; } }
+    void broadcastFill(const UserFill&) {}
+    void broadcastData(double, uint32_t) {}
+    void broadcastSentiment(long, long, long, long, long, long, long, long, long, long) {}
+    void broadcastScenarioMetrics(double, double, long, double) {}
+    void broadcastPnl(const std::array<double, NUM_AGENT_CLASSES>&, const std::vector<LedgerEntry>&) {}
+    void broadcastAccount(const AccountSnapshot&) {}
+
+    Stats stats() const {
+        Stats s;
+        s.vol = n > 1 ? std::sqrt(m2 / (n - 1) * TICKS_PER_DAY) : 0.0;
+        s.spread = spreads ? spread_sum / spreads : 0.0;
+        s.volume = n ? volume / n * TICKS_PER_DAY : 0.0;
+        return s;
+    }
+};
+
+// Runs fn(i) for i in [0, n) on up to `threads` workers.
+static void parallel_for(size_t n, int threads, const std::function<void(size_t)>& fn) {
+    std::atomic<size_t> next{0};
+    auto worker = [&] { for (size_t i; (i = next++) < n;) fn(i); };
+    int count = (int)std::min<size_t>(std::max(1, threads), std::max<size_t>(1, n));
+    std::vector<std::thread> pool; for (int w = 1; w < count; ++w) pool.emplace_back(worker);
+    worker(); for (auto& t : pool) t.join();
+}
+
+class Calibrator {
+    const Options& opt; std::vector<Param> params;
+
+public:
+    long runs = 0;
+
+    Calibrator(const Options& o, std::vector<Param> p) : opt(o), params(std::move(p)) {}
+
+    size_t dims() const { return params.size(); }
+    double to_value(size_t i, double x) const { return params[i].prob ? 1.0 / (1.0 + std::exp(-x)) : std::exp(x); }
+    double to_x(size_t i, double v) const { return params[i].prob ? std::log(v / (1.0 - v)) : std::log(v); }
+
+    ScenarioParams apply(const std::vector<double>& x) const {
+        ScenarioParams p = ScenarioParams::defaults(opt.scenario);
+        for (size_t i = 0; i < params.size(); ++i) p.*params[i].field = to_value(i, x[i]);
+        return p;
+    }
+
+    double loss(const Stats& s) const {
+        auto term = [](double got, double want) { if (std::isnan(want)) return 0.0; double r = std::log(std::max(got, 1e-12) / want); return r * r; };
+        return term(s.vol, opt.vol) + term(s.spread, opt.spread) + term(s.volume, opt.volume);
+    }
+
+    // Seed-averaged statistics for every candidate; all (candidate, seed) runs in one parallel batch
+    std::vector<Stats> evaluate(const std::vector<std::vector<double>>& xs) {
+        size_t K = opt.seeds;
+        std::vector<Stats> per_run(xs.size() * K);
+        parallel_for(per_run.size(), opt.threads, [&](size_t j) {
+            SeedSource rd(opt.seed + (unsigned int)(j % K));
+            MarketSimulation sim(opt.config, rd);
+            sim.set_phase(opt.scenario); sim.market.params = apply(xs[j / K]);
+            StatsSink out(opt.warmup); std::vector<UserOrder> none;
+            for (int t = 0; t < opt.ticks; ++t) sim.step(none, out);
+            per_run[j] = out.stats();
+        });
+        runs += per_run.size();
+        std::vector<Stats> avg(xs.size());
+        for (size_t j = 0; j < per_run.size(); ++j) { Stats& a = avg[j / K]; a.vol += per_run[j].vol / K; a.spread += per_run[j].spread / K; a.volume += per_run[j].volume / K; }
+        return avg;
+    }
+
+    void write(const std::string& path, const std::vector<double>& x, const Stats& s) const {
+        static const char* names[] = {"NORMAL", "PUMP_DUMP", "SHORT_SQUEEZE"};
+        std::ofstream f(path);
+        f << "# Fitted by calibrate (" << opt.seeds << " seeds x " << opt.ticks << " ticks, config "
+          << opt.config.num_makers << " " << opt.config.num_fundamental << " " << opt.config.num_momentum << " " << opt.config.num_noise << ")\n";
+        f << "# daily vol " << s.vol << " (target " << opt.vol << "), spread " << s.spread << " (target " << opt.spread
+          << "), volume/day " << s.volume << " (target " << opt.volume << ")\n";
+        f << "0 phase " << names[(int)opt.scenario] << "\n";
+        for (size_t i = 0; i < params.size(); ++i) f << "0 set " << params[i].name << " " << to_value(i, x[i]) << "\n";
+    }
+};
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (const char* c = std::getenv("SIM_CONFIG")) { std::stringstream ss(c); ss >> opt.config.num_makers >> opt.config.num_fundamental >> opt.config.num_momentum >> opt.config.num_noise; }
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string k = argv[i]; const char* v = argv[i + 1];
+        if (k == "--vol") opt.vol = std::atof(v);
+        else if (k == "--spread") opt.spread = std::atof(v);
+        else if (k == "--volume") opt.volume = std::atof(v);
+        else if (k == "--params") { opt.params.clear(); std::stringstream ss(v); std::string p; while (std::getline(ss, p, ',')) opt.params.push_back(p); }
+        else if (k == "--scenario") opt.scenario = static_cast<MarketScenario>(std::clamp(std::atoi(v), 0, 2));
+        else if (k == "--config") { std::stringstream ss(v); ss >> opt.config.num_makers >> opt.config.num_fundamental >> opt.config.num_momentum >> opt.config.num_noise; }
+        else if (k == "--ticks") opt.ticks = std::max(2, std::atoi(v));
+        else if (k == "--warmup") opt.warmup = std::max(0, std::atoi(v));
+        else if (k == "--seeds") opt.seeds = std::max(1, std::atoi(v));
+        else if (k == "--seed") opt.seed = (unsigned int)std::strtoul(v, nullptr, 10);
+        else if (k == "--iters") opt.iters = std::max(0, std::atoi(v));
+        else if (k == "--threads") opt.threads = std::max(1, std::atoi(v));
+        else if (k == "--out") opt.out = v;
+        else { std::cerr << "unknown option " << k << std::endl; return 1; }
+    }
+    if (std::isnan(opt.vol) && std::isnan(opt.spread) && std::isnan(opt.volume)) { std::cerr << "calibrate: give at least one of --vol, --spread, --volume" << std::endl; return 1; }
+
+    std::vector<Param> params;
+    for (auto& name : opt.params) {
+        auto field = ScenarioParams::field(name);
+        if (!field) { std::cerr << "calibrate: unknown param " << name << std::endl; return 1; }
+        params.push_back({name, field, name == "noise_hype" || name == "noise_sell_prob"});
+    }
+    Calibrator cal(opt, params);
+    size_t d = cal.dims();
+
+    // Initial simplex: the scenario defaults plus one 30% step per param (in transformed space)
+    ScenarioParams start = ScenarioParams::defaults(opt.scenario);
+    std::vector<std::vector<double>> simplex(d + 1, std::vector<double>(d));
+    for (size_t i = 0; i < d; ++i) for (size_t v = 0; v <= d; ++v) simplex[v][i] = cal.to_x(i, start.*params[i].field) + (v == i + 1 ? 0.3 : 0.0);
+    std::vector<Stats> stats = cal.evaluate(simplex);
+    std::vector<double> f(d + 1); for (size_t v = 0; v <= d; ++v) f[v] = cal.loss(stats[v]);
+
+    const double alpha = 1.0, gamma = 2.0, rho = 0.5, sigma = 0.5;
+    for (int it = 0; it < opt.iters; ++it) {
+        std::vector<size_t> order(d + 1); for (size_t v = 0; v <= d; ++v) order[v] = v;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return f[a] < f[b]; });
+        size_t best = order[0], worst = order[d], second = order[d - (d > 0 ? 1 : 0)];
+        std::fprintf(stderr, "iter %d: best loss %.5f (vol %.4f, spread %.5f, volume %.0f)\n", it, f[best], stats[best].vol, stats[best].spread, stats[best].volume);
+        if (f[worst] - f[best] < 1e-6) break;
+
+        std::vector<double> c(d, 0.0);
+        for (size_t v = 0; v <= d; ++v) if (v != worst) for (size_t i = 0; i < d; ++i) c[i] += simplex[v][i] / d;
+        auto along = [&](double t) { std::vector<double> x(d); for (size_t i = 0; i < d; ++i) x[i] = c[i] + t * (simplex[worst][i] - c[i]); return x; };
+        // Speculative batch: reflection, expansion, outside and inside contraction
+        std::vector<std::vector<double>> trial = {along(-alpha), along(-alpha * gamma), along(-alpha * rho), along(rho)};
+        std::vector<Stats> ts = cal.evaluate(trial);
+        double fr = cal.loss(ts[0]), fe = cal.loss(ts[1]), foc = cal.loss(ts[2]), fic = cal.loss(ts[3]);
+        auto accept = [&](int k, double fk) { simplex[worst] = trial[k]; stats[worst] = ts[k]; f[worst] = fk; };
+        if (fr < f[best]) { if (fe < fr) accept(1, fe); else accept(0, fr); }
+        else if (fr < f[second]) accept(0, fr);
+        else if (fr < f[worst] && foc <= fr) accept(2, foc);
+        else if (fr >= f[worst] && fic < f[worst]) accept(3, fic);
+        else {
+            // Shrink toward the best vertex
+            std::vector<std::vector<double>> moved; std::vector<size_t> idx;
+            for (size_t v = 0; v <= d; ++v) if (v != best) {
+                for (size_t i = 0; i < d; ++i) simplex[v][i] = simplex[best][i] + sigma * (simplex[v][i] - simplex[best][i]);
+                moved.push_back(simplex[v]); idx.push_back(v);
+            }
+            std::vector<Stats> ms = cal.evaluate(moved);
+            for (size_t k = 0; k < idx.size(); ++k) { stats[idx[k]] = ms[k]; f[idx[k]] = cal.loss(ms[k]); }
+        }
+    }
+
+    size_t best = std::min_element(f.begin(), f.end()) - f.begin();
+    cal.write(opt.out, simplex[best], stats[best]);
+    std::printf("Fitted in %ld runs: loss %.5f, daily vol %.4f, spread %.5f, volume/day %.0f\n", cal.runs, f[best], stats[best].vol, stats[best].spread, stats[best].volume);
+    for (size_t i = 0; i < d; ++i) std::printf("  %s = %.6g\n", params[i].name.c_str(), cal.to_value(i, simplex[best][i]));
+    std::printf("Wrote %s (use with SIM_TIMELINE=%s)\n", opt.out.c_str(), opt.out.c_str());
+    return 0;
+}
@@ -1,7 +1,13 @@
 #ifndef ENGINE_INTERFACE_HPP
 #define ENGINE_INTERFACE_HPP
 
+#ifndef HEADLESS
 #include <zmq.hpp>
+#endif
+#include "TickRecorder.hpp"
+#include "ShmRing.hpp"
+#include "AgentLedger.hpp"
+#include "UserAccounts.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,15 +16,38 @@
 #include <thread>
 #include <chrono>
 #include <map>
+#include <algorithm>
+#include <random>
+#include <cstdlib>
 
 struct SimConfig {
     int num_makers, num_fundamental, num_momentum, num_noise;
+    int num_symbols = 1;
 };
 
+// cancel_id != 0 turns the entry into a cancel request for that resting order.
 struct UserOrder {
-    bool is_buy; int quantity; double price;
+    bool is_buy; int quantity; double price; uint32_t user = 0; uint64_t cancel_id = 0; uint32_t symbol = 0;
 };
 
+// Multi-book engines put the symbol in the top bits of their order ids, so a CANCEL is
+// routed to its book without a lookup.
+constexpr int SYMBOL_ID_SHIFT = 40;
+
+// Seeds for agent and engine RNGs. SIM_SEED=<n> makes a run reproducible
+// (benchmarks, PGO training); otherwise seeds come from std::random_device.
+class SeedSource {
+    std::random_device rd; std::mt19937 seq; bool fixed = false;
+public:
+    SeedSource() { if (const char* s = std::getenv("SIM_SEED")) { seq.seed((unsigned int)std::strtoul(s, nullptr, 10)); fixed = true; } }
+    explicit SeedSource(unsigned int seed) : seq(seed), fixed(true) {}
+    unsigned int operator()() { return fixed ? (unsigned int)seq() : rd(); }
+};
+
+// Ticks between the engines' throttled broadcasts (sentiment, data, P&L, accounts).
+// SIM_PUBLISH_EVERY=1 publishes every tick; the server conflates per client.
+inline int publishInterval() { static const int n = [] { const char* e = std::getenv("SIM_PUBLISH_EVERY"); return e ? std::max(1, std::atoi(e)) : 10; }(); return n; }
+
 enum class MarketScenario { NORMAL = 0, PUMP_DUMP = 1, SHORT_SQUEEZE = 2 };
 
 struct AgentStats {
@@ -27,12 +56,67 @@ struct AgentStats {
     void reset() { buy_vol = 0; sell_vol = 0; }
 };
 
+#ifdef HEADLESS
+// Headless build (make headless): no ZMQ, no pacing. Population, run length and
+// scenario come from SIM_CONFIG, SIM_TICKS and SIM_SCENARIO so runs can be
+// batch-recorded (SIM_RECORD) and benchmarked.
+class EngineInterface {
+private:
+    SimConfig config{200, 200, 175, 350};
+    long max_ticks = 100000; long ticks = 0; int scenario = -1;
+    TickRecorder recorder;
+    MarketDataRing ring; int symbol = 0;
+    std::chrono::steady_clock::time_point started;
+    FILE* diag = nullptr;
+
+public:
+    EngineInterface() {
+        if (const char* d = std::getenv("SIM_DIAG")) diag = std::fopen(d, "w");
+        if (const char* c = std::getenv("SIM_CONFIG")) { std::stringstream ss(c); ss >> config.num_makers >> config.num_fundamental >> config.num_momentum >> config.num_noise; }
+        if (const char* t = std::getenv("SIM_TICKS")) max_ticks = std::atol(t);
+        if (const char* s = std::getenv("SIM_SCENARIO")) scenario = std::atoi(s);
+        if (const char* n = std::getenv("SIM_SYMBOLS")) config.num_symbols = std::max(1, std::atoi(n));
+    }
+    ~EngineInterface() {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::cout << "Headless run: " << ticks << " ticks in " << secs << "s (" << (secs > 0 ? ticks / secs : 0.0) << " ticks/s)" << std::endl;
+        if (diag) std::fclose(diag);
+    }
+
+    SimConfig waitForStart() { started = std::chrono::steady_clock::now(); return config; }
+
+    int checkCommands(std::vector<UserOrder>& new_orders) {
+        if (ticks >= max_ticks) return -2;
+        if (++ticks == 1) return scenario;
+        return -1;
+    }
+
+    void waitForNextTick(std::chrono::steady_clock::time_point) {}
+    void setSymbol(int s) { symbol = s; }
+    void recordTick(double time, double price, uint64_t volume) { recorder.record(time, price, volume); }
+
+    // Only the shared-memory feed (SIM_SHM) is live headless
+    void broadcastData(double price, uint32_t volume) { ring.write(RecordType::DATA, symbol, {price, (double)volume}); }
+    void broadcastTrade(std::string agent, bool is_buy, int qty, double price) { ring.write(RecordType::TRADE, symbol, {(double)is_buy, (double)qty, price}, agent.c_str()); }
+    void broadcastSentiment(long fb, long fs, long mb, long ms, long mkb, long mks, long nb, long ns, long ub, long us) { ring.write(RecordType::SENTIMENT, symbol, {(double)fb, (double)fs, (double)mb, (double)ms, (double)mkb, (double)mks, (double)nb, (double)ns, (double)ub, (double)us}); }
+    void broadcastScenarioMetrics(double hype, double bubble, long short_interest, double panic) { ring.write(RecordType::SCENARIO_METRICS, symbol, {hype, bubble, (double)short_interest, panic}); }
+    void broadcastMetrics(double spread, long liquidity) { ring.write(RecordType::METRICS, symbol, {spread, (double)liquidity}); }
+    void broadcastPnl(const std::array<double, NUM_AGENT_CLASSES>& c, const std::vector<LedgerEntry>&) { ring.write(RecordType::PNL, symbol, {c[0], c[1], c[2], c[3], c[4]}); }
+    void broadcastFill(const UserFill&) {}
+    void broadcastAccount(const AccountSnapshot&) {}
+    // Diagnostics lines (SIM_PERF, SIM_MEMORY) go to SIM_DIAG=<file> when set
+    void broadcastDiagnostics(const std::string& line) { if (diag) std::fprintf(diag, "%s\n", line.c_str()); }
+};
+#else
 class EngineInterface {
 private:
     zmq::context_t context;
     zmq::socket_t publisher; 
     zmq::socket_t command_sub; 
     bool is_paused;
+    TickRecorder recorder;
+    MarketDataRing ring; int symbol = 0;
+    std::string topic;
     
 public:
     EngineInterface() : context(1), publisher(context, ZMQ_PUB), command_sub(context, ZMQ_SUB), is_paused(false) {
@@ -53,6 +137,7 @@ public:
                 std::stringstream ss(s); std::string cmd; ss >> cmd;
                 if (cmd == "START") {
                     SimConfig c; ss >> c.num_makers >> c.num_fundamental >> c.num_momentum >> c.num_noise;
+                    int symbols; if (ss >> symbols) c.num_symbols = std::max(1, symbols);
                     command_sub.set(zmq::sockopt::rcvtimeo, 0); is_paused = false; return c;
                 }
             }
@@ -80,40 +165,85 @@ public:
             }
 
             if (cmd == "ORDER") {
-                int side, qty; double price; ss >> side >> qty >> price;
-                new_orders.push_back({side == 0, qty, price});
+                int side, qty; double price; uint32_t user = 0, symbol = 0; ss >> side >> qty >> price >> user >> symbol;
+                new_orders.push_back({side == 0, qty, price, user, 0, symbol});
+            }
+
+            if (cmd == "CANCEL") {
+                uint32_t user; uint64_t id; ss >> user >> id;
+                new_orders.push_back({false, 0, 0.0, user, id});
             }
         }
     }
 
+    // Multi-symbol engines prefix every message with "S<symbol> " so subscribers can
+    // filter per symbol with a plain ZMQ prefix subscription; -1 clears the tag.
+    void setSymbol(int s) { symbol = s; topic = s < 0 ? "" : "S" + std::to_string(s) + " "; }
+    void publish(const std::string& s) { std::string msg = topic + s; zmq::message_t m(msg.data(), msg.size()); publisher.send(m, zmq::send_flags::none); }
+
+    // Paces the sim loop at 50Hz.
+    void waitForNextTick(std::chrono::steady_clock::time_point start_tick) { std::this_thread::sleep_until(start_tick + std::chrono::milliseconds(20)); }
+    void recordTick(double time, double price, uint64_t volume) { recorder.record(time, price, volume); }
+
+    // Market data also goes to the shared-memory ring when SIM_SHM is set (ShmRing.hpp).
     void broadcastData(double price, uint32_t volume) {
-        std::string msg = "DATA " + std::to_string(price) + " " + std::to_string(volume);
-        zmq::message_t message(msg.data(), msg.size());
-        publisher.send(message, zmq::send_flags::none);
+        ring.write(RecordType::DATA, symbol, {price, (double)volume});
+        publish("DATA " + std::to_string(price) + " " + std::to_string(volume) + " " + std::to_string(wall_clock_ns()));
     }
 
     void broadcastTrade(std::string agent, bool is_buy, int qty, double price) {
+        ring.write(RecordType::TRADE, symbol, {(double)is_buy, (double)qty, price}, agent.c_str());
         std::stringstream ss; ss << "TRADE " << agent << " " << (is_buy ? "BUY" : "SELL") << " " << qty << " " << price;
-        std::string s = ss.str(); zmq::message_t m(s.data(), s.size()); publisher.send(m, zmq::send_flags::none);
+        publish(ss.str());
     }
 
     void broadcastSentiment(long fb, long fs, long mb, long ms, long mkb, long mks, long nb, long ns, long ub, long us) {
+        ring.write(RecordType::SENTIMENT, symbol, {(double)fb, (double)fs, (double)mb, (double)ms, (double)mkb, (double)mks, (double)nb, (double)ns, (double)ub, (double)us});
         std::stringstream ss;
         ss << "SENTIMENT " << fb << " " << fs << " " << mb << " " << ms << " " << mkb << " " << mks << " " << nb << " " << ns << " " << ub << " " << us;
-        std::string s = ss.str(); zmq::message_t m(s.data(), s.size()); publisher.send(m, zmq::send_flags::none);
+        publish(ss.str());
     }
 
     void broadcastScenarioMetrics(double hype, double bubble, long short_interest, double panic) {
+        ring.write(RecordType::SCENARIO_METRICS, symbol, {hype, bubble, (double)short_interest, panic});
         std::stringstream ss;
         ss << "SCENARIO_METRICS " << hype << " " << bubble << " " << short_interest << " " << panic;
-        std::string s = ss.str(); zmq::message_t m(s.data(), s.size()); publisher.send(m, zmq::send_flags::none);
+        publish(ss.str());
     }
 
     // ADDED: Missing function that caused the error
     void broadcastMetrics(double spread, long liquidity) {
+        ring.write(RecordType::METRICS, symbol, {spread, (double)liquidity});
         std::stringstream ss;
         ss << "METRICS " << spread << " " << liquidity;
-        std::string s = ss.str(); zmq::message_t m(s.data(), s.size()); publisher.send(m, zmq::send_flags::none);
+        publish(ss.str());
+    }
+
+    // FILL <user> <BUY|SELL> <qty> <price> <order_id>: one per user fill, passive ones included
+    void broadcastFill(const UserFill& f) {
+        std::stringstream ss; ss << "FILL " << f.user << " " << (f.is_buy ? "BUY" : "SELL") << " " << f.quantity << " " << f.price << " " << f.order_id;
+        publish(ss.str());
+    }
+
+    // ACCOUNT <user> <position> <cash> <realized> <unrealized> <n> then n x (<order_id> <BUY|SELL> <price> <remaining>)
+    void broadcastAccount(const AccountSnapshot& a) {
+        std::stringstream ss;
+        ss << "ACCOUNT " << a.user << " " << a.position << " " << a.cash << " " << a.realized << " " << a.unrealized << " " << a.open.size();
+        for (auto& o : a.open) ss << " " << o.id << " " << (o.side == Side::BUY ? "BUY" : "SELL") << " " << o.price << " " << o.remaining;
+        publish(ss.str());
+    }
+
+    // Diagnostics (PERF lines from SIM_PERF, MEMORY from SIM_MEMORY) share the market data socket
+    void broadcastDiagnostics(const std::string& line) { publish(line); }
+
+    // PNL <fund> <mom> <maker> <noise> <user> <n> then n x (<account> <class> <pnl>)
+    void broadcastPnl(const std::array<double, NUM_AGENT_CLASSES>& class_pnl, const std::vector<LedgerEntry>& leaders) {
+        ring.write(RecordType::PNL, symbol, {class_pnl[0], class_pnl[1], class_pnl[2], class_pnl[3], class_pnl[4]});
+        std::stringstream ss;
+        ss << "PNL"; for (double p : class_pnl) ss << " " << p;
+        ss << " " << leaders.size(); for (auto& e : leaders) ss << " " << e.account << " " << (int)e.cls << " " << e.pnl;
+        publish(ss.str());
     }
 };
+#endif
 #endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef EVENT_QUEUE_HPP
+#define EVENT_QUEUE_HPP
+
+#include "MemoryAccounting.hpp"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Agent wake-ups for the discrete-event kernel, keyed by integer simulation nanoseconds so
+// ordering never depends on floating-point comparisons. Equal times pop in push order,
+// which keeps seeded runs reproducible. `who` is an engine-defined agent handle.
+struct WakeEvent { int64_t t_ns; uint64_t seq; uint32_t who; };
+
+class EventQueue {
+private:
+    std::vector<WakeEvent> heap; uint64_t seq = 0;
+    static bool later(const WakeEvent& a, const WakeEvent& b) { return a.t_ns != b.t_ns ? a.t_ns > b.t_ns : a.seq > b.seq; }
+
+public:
+    static int64_t to_ns(double seconds) { return (int64_t)std::llround(seconds * 1e9); }
+
+    void reserve(size_t n) { heap.reserve(n); }
+    void push(double t, uint32_t who) { heap.push_back({to_ns(t), seq++, who}); std::push_heap(heap.begin(), heap.end(), later); }
+    bool due(int64_t t_ns) const { return !heap.empty() && heap.front().t_ns <= t_ns; }
+    WakeEvent pop() { std::pop_heap(heap.begin(), heap.end(), later); WakeEvent e = heap.back(); heap.pop_back(); return e; }
+    size_t size() const { return heap.size(); }
+    size_t memory_bytes() const { return vector_bytes(heap); }
+};
+#endif
@@ -0,0 +1,109 @@
+#ifndef FUNDAMENTAL_PROCESS_HPP
+#define FUNDAMENTAL_PROCESS_HPP
+
+#include "SimdDispatch.hpp"
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// Correlated GBM fundamentals for N assets. Each step draws N (or K + N) standard normals
+// and maps them to correlated shocks, either through a full Cholesky factor of the
+// correlation matrix (O(N^2) per step) or through a factor model (O(N*K)):
+//     x_i = sum_k B_ik f_k + sqrt(1 - |B_i|^2) e_i,   corr(i, j) = B_i . B_j
+// Sector structure is the factor model with a market factor plus one factor per sector.
+class FundamentalProcess {
+private:
+    size_t n = 0, k = 0, stride = 0;      // stride: padded column length (multiple of 4)
+    std::vector<double> value, mu, sigma;
+    std::vector<double> chol;              // lower Cholesky factor, column-major, padded
+    std::vector<double> loading, idio;     // factor model: loading column-major N x K, idio[i] = sqrt(1 - |B_i|^2)
+    std::vector<double> z, f, x;
+    std::mt19937_64 gen; std::normal_distribution<> Z{0.0, 1.0};
+
+    static size_t pad(size_t n) { return (n + 3) & ~size_t(3); }
+
+    // x += A[:, c0..c1) * v[c0..c1) for a column-major A with the given stride; columns are
+    // consumed four at a time so each pass over x does four FMAs per load/store. Lower-
+    // triangular factors start each block at row c0 (rows above are zero).
+    SIM_TARGET_CLONES static void gemv_cols(const double* __restrict A, size_t stride, size_t rows, size_t c1, const double* __restrict v, double* __restrict out, bool lower) {
+        size_t c = 0;
+        for (; c + 4 <= c1; c += 4) {
+            const double *a0 = A + c * stride, *a1 = a0 + stride, *a2 = a1 + stride, *a3 = a2 + stride;
+            double v0 = v[c], v1 = v[c + 1], v2 = v[c + 2], v3 = v[c + 3];
+            for (size_t i = lower ? c : 0; i < rows; ++i) out[i] += a0[i] * v0 + a1[i] * v1 + a2[i] * v2 + a3[i] * v3;
+        }
+        for (; c < c1; ++c) { const double* a = A + c * stride; double vc = v[c]; for (size_t i = lower ? c : 0; i < rows; ++i) out[i] += a[i] * vc; }
+    }
+
+public:
+    FundamentalProcess(std::vector<double> value0, std::vector<double> annual_return, std::vector<double> annual_volatility, uint64_t seed)
+        : n(value0.size()), stride(pad(value0.size())), value(std::move(value0)), mu(std::move(annual_return)), sigma(std::move(annual_volatility)), z(stride), x(stride), gen(seed) {}
+
+    // Uncorrelated helper for the common case: every asset starts at p0 with the same drift/vol.
+    FundamentalProcess(size_t assets, double p0, double annual_return, double annual_volatility, uint64_t seed)
+        : FundamentalProcess(std::vector<double>(assets, p0), std::vector<double>(assets, annual_return), std::vector<double>(assets, annual_volatility), seed) {}
+
+    // Full correlation matrix, row-major N x N. Returns false (and keeps the previous
+    // structure) if it is not positive definite.
+    bool set_correlation(const std::vector<double>& corr) {
+        std::vector<double> L(stride * n, 0.0); // column-major: L[j * stride + i]
+        for (size_t j = 0; j < n; ++j) {
+            double d = corr[j * n + j];
+            for (size_t p = 0; p < j; ++p) d -= L[p * stride + j] * L[p * stride + j];
+            if (d <= 0.0) return false;
+            double ljj = std::sqrt(d); L[j * stride + j] = ljj;
+            for (size_t i = j + 1; i < n; ++i) {
+                double s = corr[i * n + j];
+                for (size_t p = 0; p < j; ++p) s -= L[p * stride + i] * L[p * stride + j];
+                L[j * stride + i] = s / ljj;
+            }
+        }
+        chol.swap(L); loading.clear(); idio.clear(); k = 0;
+        return true;
+    }
+
+    // Factor model from an N x K row-major loading matrix. Rows with |B_i| >= 1 are scaled
+    // to 0.999 so every asset keeps a little idiosyncratic risk.
+    void set_factors(const std::vector<double>& B, size_t factors) {
+        k = factors; loading.assign(stride * k, 0.0); idio.assign(stride, 0.0); f.assign(k, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            double norm2 = 0.0; for (size_t q = 0; q < k; ++q) norm2 += B[i * k + q] * B[i * k + q];
+            double scale = norm2 >= 0.999 * 0.999 ? 0.999 / std::sqrt(norm2) : 1.0;
+            for (size_t q = 0; q < k; ++q) loading[q * stride + i] = B[i * k + q] * scale;
+            idio[i] = std::sqrt(std::max(0.0, 1.0 - norm2 * scale * scale));
+        }
+        chol.clear();
+    }
+
+    // Market + sector factors: corr = market^2 + sector^2 within a sector, market^2 across.
+    void set_sectors(const std::vector<int>& sector_of, double market_corr, double sector_corr) {
+        size_t sectors = 0; for (int s : sector_of) sectors = std::max(sectors, (size_t)s + 1);
+        std::vector<double> B(n * (1 + sectors), 0.0);
+        double m = std::sqrt(std::max(0.0, market_corr)), s = std::sqrt(std::max(0.0, sector_corr - market_corr));
+        for (size_t i = 0; i < n; ++i) { B[i * (1 + sectors)] = m; B[i * (1 + sectors) + 1 + sector_of[i]] = s; }
+        set_factors(B, 1 + sectors);
+    }
+
+    void step(double dt_year) {
+        for (size_t i = 0; i < n; ++i) z[i] = Z(gen);
+        if (!chol.empty()) {
+            std::fill(x.begin(), x.end(), 0.0);
+            gemv_cols(chol.data(), stride, n, n, z.data(), x.data(), true);
+        } else if (k) {
+            for (auto& v : f) v = Z(gen);
+            for (size_t i = 0; i < n; ++i) x[i] = idio[i] * z[i];
+            gemv_cols(loading.data(), stride, n, k, f.data(), x.data(), false);
+        } else {
+            std::copy(z.begin(), z.end(), x.begin());
+        }
+        double sq = std::sqrt(dt_year);
+        for (size_t i = 0; i < n; ++i) value[i] *= std::exp((mu[i] - 0.5 * sigma[i] * sigma[i]) * dt_year + sigma[i] * sq * x[i]);
+    }
+
+    size_t size() const { return n; }
+    double operator[](size_t i) const { return value[i]; }
+    const std::vector<double>& values() const { return value; }
+};
+#endif
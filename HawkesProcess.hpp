@@ -0,0 +1,76 @@
+#ifndef HAWKES_PROCESS_HPP
+#define HAWKES_PROCESS_HPP
+
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// Multivariate Hawkes process with exponential kernels sharing one decay rate:
+//     lambda_i(t) = mu_i + sum_j sum_{t_k in j, t_k < t} alpha_ij * exp(-beta (t - t_k))
+// The excitation sums decay as a group and jump by alpha[:, j] on an event in j, so each
+// event costs O(dims) whatever the history length. Events are sampled by Ogata thinning:
+// the intensity only decays between events, so its current value bounds the next
+// candidate and a candidate costs two uniform draws and one exp().
+class HawkesProcess {
+private:
+    size_t d;
+    std::vector<double> mu, alpha, excite; // alpha[i * d + j]: jump in lambda_i from an event in j
+    double beta, t = 0.0;
+    std::mt19937_64 gen; std::uniform_real_distribution<> U{0.0, 1.0};
+    double pending_t = -1.0; int pending_dim = -1;
+
+    double intensity() const { double s = 0.0; for (size_t i = 0; i < d; ++i) s += mu[i] + excite[i]; return s; }
+    void draw() {
+        while (true) {
+            double bound = intensity();
+            if (bound <= 0.0) { pending_t = INFINITY; pending_dim = -1; return; }
+            double w = -std::log(1.0 - U(gen)) / bound;
+            t += w; double k = std::exp(-beta * w);
+            for (auto& e : excite) e *= k;
+            double lambda = intensity(), u = U(gen) * bound;
+            if (u > lambda) continue;
+            // accepted: u is uniform on [0, lambda), reuse it to pick the dimension
+            size_t i = 0; for (double c = mu[0] + excite[0]; c <= u && i + 1 < d; c += mu[i] + excite[i]) ++i;
+            pending_t = t; pending_dim = (int)i; return;
+        }
+    }
+
+public:
+    HawkesProcess(size_t dims, double decay, uint64_t seed) : d(dims), mu(dims, 0.0), alpha(dims * dims, 0.0), excite(dims, 0.0), beta(decay), gen(seed) {}
+
+    size_t dims() const { return d; }
+    void set_excitation(size_t i, size_t j, double a) { alpha[i * d + j] = a; }
+    // Applies to candidates drawn from now on
+    void set_baseline(size_t i, double rate) { mu[i] = rate; }
+
+    // Baselines giving long-run mean rates `target` (rates = (I - A/beta)^-1 mu, so
+    // mu = (I - A/beta) target); needs a stable branching matrix A/beta.
+    void match_mean_rates(const std::vector<double>& target) {
+        std::vector<double> m(target);
+        for (size_t i = 0; i < d; ++i) for (size_t j = 0; j < d; ++j) m[i] -= alpha[i * d + j] / beta * target[j];
+        for (size_t i = 0; i < d; ++i) mu[i] = std::max(0.0, m[i]);
+    }
+
+    // Kernels for a population with long-run class rates `target`: each class excites itself
+    // with branching ratio `self` and every other class with `cross` scaled by the rate ratio
+    // (alpha_ij / beta = cross * target_i / target_j), so small classes are not swamped by
+    // busy ones. The branching matrix is then similar to self*I + cross*(J - I), stable
+    // while self + (dims - 1) * cross < 1, and each mu_i = target_i * (1 - self - (dims - 1) * cross).
+    void calibrate(const std::vector<double>& target, double self, double cross) {
+        for (size_t i = 0; i < d; ++i) for (size_t j = 0; j < d; ++j)
+            alpha[i * d + j] = beta * (i == j ? self : (target[j] > 0 ? cross * target[i] / target[j] : 0.0));
+        match_mean_rates(target);
+    }
+
+    // Next event (time and dimension) without consuming it
+    double peek_time() { if (pending_dim < 0) draw(); return pending_t; }
+    int pop(double& when) {
+        peek_time(); int i = pending_dim; when = pending_t;
+        if (i >= 0) for (size_t r = 0; r < d; ++r) excite[r] += alpha[r * d + i];
+        pending_dim = -1; pending_t = -1.0;
+        return i;
+    }
+};
+#endif
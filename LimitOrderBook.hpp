@@ -0,0 +1,123 @@
+#ifndef LIMIT_ORDER_BOOK_HPP
+#define LIMIT_ORDER_BOOK_HPP
+
+#include "MemoryAccounting.hpp"
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+enum class Side { BUY, SELL };
+// owner is the ledger account of the agent (or user) that sent the order.
+struct Order { uint64_t id; double timestamp; double price; uint32_t quantity; Side side; uint32_t owner = 0; };
+struct Trade { double price; uint32_t quantity; double timestamp; uint32_t buyer = 0; uint32_t seller = 0; uint64_t resting_id = 0; };
+
+class LimitOrderBook {
+private:
+    std::unordered_map<uint64_t, Order> active_orders;
+    struct askComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price > b.price : a.timestamp > b.timestamp; } };
+    struct bidComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price < b.price : a.timestamp > b.timestamp; } };
+    // priority_queue keeps its array in the protected member c
+    template <typename Q> static typename Q::container_type& heap_array(Q& q) {
+        struct Access : Q { static typename Q::container_type& of(Q& q) { return q.*(&Access::c); } };
+        return Access::of(q);
+    }
+public:
+    std::priority_queue<Order, std::vector<Order>, askComp> askHeap;
+    std::priority_queue<Order, std::vector<Order>, bidComp> bidHeap;
+    double last_traded_price;
+
+    explicit LimitOrderBook(size_t reserve = 500000) { active_orders.reserve(reserve); last_traded_price = 100.0; }
+    double get_mid(double fallback) { if (askHeap.empty() || bidHeap.empty()) return fallback; return 0.5 * (askHeap.top().price + bidHeap.top().price); }
+
+    bool is_active(uint64_t id) const { return active_orders.count(id) != 0; }
+    size_t live_orders() const { return active_orders.size(); }
+    size_t index_bytes() const { return hash_bytes(active_orders); }
+    size_t heap_bytes() const { return vector_bytes(heap_array(const_cast<decltype(askHeap)&>(askHeap))) + vector_bytes(heap_array(const_cast<decltype(bidHeap)&>(bidHeap))); }
+    // Lazy cancel: the heap entry is skipped as a tombstone, like decayed orders.
+    bool cancel(uint64_t id) { return active_orders.erase(id) != 0; }
+
+    void clean_heaps() {
+        while (!askHeap.empty() && !active_orders.count(askHeap.top().id)) askHeap.pop();
+        while (!bidHeap.empty() && !active_orders.count(bidHeap.top().id)) bidHeap.pop();
+    }
+
+    std::pair<double, long> get_metrics() {
+        clean_heaps();
+        double spread = 0.0;
+        long liquidity = 0;
+        if (!askHeap.empty() && !bidHeap.empty()) {
+            spread = askHeap.top().price - bidHeap.top().price;
+            liquidity = askHeap.top().quantity + bidHeap.top().quantity;
+        }
+        return {spread, liquidity};
+    }
+
+    void decay(double percentage, std::mt19937& gen) {
+        if (active_orders.empty()) return;
+        std::vector<uint64_t> to_delete;
+        std::uniform_real_distribution<> dist(0.0, 1.0);
+        for (auto const& [id, order] : active_orders) { if (dist(gen) < percentage) to_delete.push_back(id); }
+        for (uint64_t id : to_delete) active_orders.erase(id);
+    }
+
+    // Bulk load of resting orders in O(n + book): entries are appended to the heap arrays and
+    // heapified once instead of pushed one by one (O(n log n)); a batch sorted best-first is
+    // already in heap order. Orders that would cross the book or the batch's opposite side go
+    // through add_order afterwards, in batch order, and match. Returns the orders loaded directly.
+    size_t load(const std::vector<Order>& orders) {
+        clean_heaps();
+        double ask = askHeap.empty() ? HUGE_VAL : askHeap.top().price, bid = bidHeap.empty() ? -HUGE_VAL : bidHeap.top().price;
+        double batch_ask = HUGE_VAL, batch_bid = -HUGE_VAL; size_t sells = 0;
+        for (auto& o : orders) { if (o.side == Side::SELL) { batch_ask = std::min(batch_ask, o.price); ++sells; } else batch_bid = std::max(batch_bid, o.price); }
+        ask = std::min(ask, batch_ask); bid = std::max(bid, batch_bid);
+        auto& asks = heap_array(askHeap); auto& bids = heap_array(bidHeap);
+        asks.reserve(asks.size() + sells); bids.reserve(bids.size() + orders.size() - sells);
+        active_orders.reserve(active_orders.size() + orders.size());
+        std::vector<Order> crossing; size_t loaded = 0;
+        for (auto& o : orders) {
+            bool rests = o.side == Side::SELL ? o.price > bid : o.price < ask;
+            if (!rests || o.quantity == 0) { if (o.quantity) crossing.push_back(o); continue; }
+            active_orders[o.id] = o; (o.side == Side::SELL ? asks : bids).push_back(o); ++loaded;
+        }
+        std::make_heap(asks.begin(), asks.end(), askComp{}); std::make_heap(bids.begin(), bids.end(), bidComp{});
+        for (auto& o : crossing) add_order(o);
+        return loaded;
+    }
+
+    std::vector<Trade> add_order(Order order) {
+        std::vector<Trade> trades;
+        if (order.side == Side::SELL) {
+            while (order.quantity > 0 && !bidHeap.empty()) {
+                if (!active_orders.count(bidHeap.top().id)) { bidHeap.pop(); continue; }
+                const Order& best = bidHeap.top();
+                if (best.price < order.price) break;
+                uint32_t qty = std::min(best.quantity, order.quantity);
+                trades.push_back({best.price, qty, order.timestamp, best.owner, order.owner, best.id});
+                last_traded_price = best.price;
+                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; bidHeap.pop(); bidHeap.push(updated); }
+                else { active_orders.erase(best.id); bidHeap.pop(); }
+                order.quantity -= qty;
+            }
+            if (order.quantity > 0) { active_orders[order.id] = order; askHeap.push(order); }
+        } else {
+            while (order.quantity > 0 && !askHeap.empty()) {
+                if (!active_orders.count(askHeap.top().id)) { askHeap.pop(); continue; }
+                const Order& best = askHeap.top();
+                if (best.price > order.price) break;
+                uint32_t qty = std::min(best.quantity, order.quantity);
+                trades.push_back({best.price, qty, order.timestamp, order.owner, best.owner, best.id});
+                last_traded_price = best.price;
+                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; askHeap.pop(); askHeap.push(updated); }
+                else { active_orders.erase(best.id); askHeap.pop(); }
+                order.quantity -= qty;
+            }
+            if (order.quantity > 0) { active_orders[order.id] = order; bidHeap.push(order); }
+        }
+        return trades;
+    }
+};
+#endif
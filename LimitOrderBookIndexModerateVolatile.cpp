@@ -1,5 +1,11 @@
 #include "EngineInterface.hpp"
+#include "LimitOrderBook.hpp"
+#include "AgentLedger.hpp"
+#include "UserAccounts.hpp"
+#include "ShardPool.hpp"
+#include "PhaseTrace.hpp"
 #include <vector>
+#include <memory>
 #include <queue>
 #include <unordered_map>
 #include <optional>
@@ -11,48 +17,7 @@
 #include <chrono>
 #include <thread>
 
-enum class Side { BUY, SELL };
-struct Order { uint64_t id; double timestamp; double price; uint32_t quantity; Side side; };
-struct Trade { double price; uint32_t quantity; double timestamp; };
-
-class LimitOrderBook {
-private:
-    std::unordered_map<uint64_t, Order> active_orders;
-    struct askComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price > b.price : a.timestamp > b.timestamp; } };
-    struct bidComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price < b.price : a.timestamp > b.timestamp; } };
-public:
-    std::priority_queue<Order, std::vector<Order>, askComp> askHeap;
-    std::priority_queue<Order, std::vector<Order>, bidComp> bidHeap;
-    LimitOrderBook() { active_orders.reserve(500000); }
-    double get_mid(double fallback) { if (askHeap.empty() || bidHeap.empty()) return fallback; return 0.5 * (askHeap.top().price + bidHeap.top().price); }
-    std::vector<Trade> add_order(Order order) {
-        std::vector<Trade> trades;
-        if (order.side == Side::SELL) {
-            while (order.quantity > 0 && !bidHeap.empty()) {
-                if (!active_orders.count(bidHeap.top().id)) { bidHeap.pop(); continue; }
-                const Order& best = bidHeap.top(); if (best.price < order.price) break;
-                uint32_t qty = std::min(best.quantity, order.quantity); trades.push_back({best.price, qty, order.timestamp});
-                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; bidHeap.pop(); bidHeap.push(updated); } 
-                else { active_orders.erase(best.id); bidHeap.pop(); }
-                order.quantity -= qty;
-            }
-            if (order.quantity > 0) { active_orders[order.id] = order; askHeap.push(order); }
-        } else {
-            while (order.quantity > 0 && !askHeap.empty()) {
-                if (!active_orders.count(askHeap.top().id)) { askHeap.pop(); continue; }
-                const Order& best = askHeap.top(); if (best.price > order.price) break;
-                uint32_t qty = std::min(best.quantity, order.quantity); trades.push_back({best.price, qty, order.timestamp});
-                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; askHeap.pop(); askHeap.push(updated); } 
-                else { active_orders.erase(best.id); askHeap.pop(); }
-                order.quantity -= qty;
-            }
-            if (order.quantity > 0) { active_orders[order.id] = order; bidHeap.push(order); }
-        }
-        return trades;
-    }
-};
-
-class Agent { public: virtual ~Agent() = default; virtual std::optional<Order> act(double mid, double vol, double time, uint64_t& id) = 0; virtual std::string get_name() = 0; };
+class Agent { public: virtual ~Agent() = default; virtual std::optional<Order> act(double mid, double vol, double time, uint64_t& id) = 0; virtual std::string get_name() = 0; uint32_t account = 0; };
 class MarketMaker : public Agent {
     std::mt19937 gen; std::exponential_distribution<> wake_dist; std::uniform_int_distribution<> size_dist; std::uniform_real_distribution<> spread_jitter; double next_act_time;
 public:
@@ -115,8 +80,225 @@ public:
     }
 };
 
+// Trades the index book against the basket's fair value and hedges each fill with the
+// opposite basket in the constituent books. Orders are IOC: any unfilled remainder is
+// cancelled so the arbitrageur stays (roughly) delta neutral.
+class IndexArbitrageur : public Agent {
+    std::mt19937 gen; std::exponential_distribution<> wake_dist; double threshold; double next_act_time;
+public:
+    std::vector<uint32_t> leg_account; // account in each constituent's ledger
+    IndexArbitrageur(unsigned int seed) : gen(seed) { wake_dist = std::exponential_distribution<>(1.0/2.0); threshold = std::uniform_real_distribution<>(0.0005, 0.002)(gen); next_act_time = 0; }
+    std::string get_name() override { return "ARBITRAGE"; }
+    std::optional<Order> act_with_index(double fair, double index_mid, double time, uint64_t& id) {
+        if (time < next_act_time) return std::nullopt;
+        next_act_time = time + wake_dist(gen);
+        double deviation = (index_mid - fair) / fair;
+        if (std::abs(deviation) < threshold) return std::nullopt;
+        uint32_t qty = 20 + static_cast<uint32_t>(std::min(1.0, std::abs(deviation) / 0.01) * 180);
+        if (deviation > 0) return Order{id++, time, fair * (1.0 + threshold), qty, Side::SELL};
+        else return Order{id++, time, fair * (1.0 - threshold), qty, Side::BUY};
+    }
+    std::optional<Order> act(double mid, double vol, double time, uint64_t& id) override { return std::nullopt; }
+};
+
+// Index level = sum_i weight_i * mid_i, maintained incrementally so a constituent price
+// change costs O(1) whatever the basket size. resum() bounds floating-point drift.
+struct IndexBasket {
+    std::vector<double> weight, mid; double level = 0.0;
+    void add(double w, double m) { weight.push_back(w); mid.push_back(m); level += w * m; }
+    void update(size_t i, double m) { level += weight[i] * (m - mid[i]); mid[i] = m; }
+    void resum() { level = 0.0; for (size_t i = 0; i < mid.size(); ++i) level += weight[i] * mid[i]; }
+};
+
+// One constituent stock: own book, GBM fundamental and moderate-profile population.
+// Stepped by a ShardPool worker; the main thread only touches it between barriers.
+struct Constituent {
+    uint32_t symbol; LimitOrderBook book; std::mt19937 gen; std::normal_distribution<> Z{0.0, 1.0};
+    double true_value, price, last_price, realized_vol = 0.005; uint64_t oid; uint32_t tick_volume = 0, publish_volume = 0;
+    std::vector<MarketMaker> makers; std::vector<FundamentalTrader> fundamental; std::vector<NoiseTrader> noise; std::vector<MomentumTrader> momentum;
+    AgentLedger ledger; UserAccounts users; std::vector<UserOrder> inbox;
+    AgentStats s_fund, s_mom, s_make, s_noise, s_user;
+
+    Constituent(uint32_t s, double p0, unsigned int seed) : symbol(s), book(50000), gen(seed), true_value(p0), price(p0), last_price(p0), oid(((uint64_t)s << SYMBOL_ID_SHIFT) + 1) {}
+
+    void fill(const Order& o, const std::vector<Trade>& trades, AgentStats& stats) {
+        for (auto& t : trades) { tick_volume += t.quantity; price = t.price; stats.add(o.side == Side::BUY, t.quantity); ledger.on_fill(t); }
+        users.on_trades(o, trades);
+    }
+
+    void step(double time, double dt_step, int sub_steps, double annual_return, double annual_volatility, double seconds_per_year) {
+        SIM_TRACE("constituent");
+        tick_volume = 0;
+        for (auto& u : inbox) {
+            if (u.cancel_id) { users.cancel(u.user, u.cancel_id, book); continue; }
+            Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL, users.ledger_account(u.user, ledger)};
+            fill(o, book.add_order(o), s_user);
+        }
+        inbox.clear();
+        for (int s = 0; s < sub_steps; ++s) {
+            double t = time + (s + 1) * dt_step, dt_year = dt_step / seconds_per_year;
+            true_value *= std::exp((annual_return - 0.5 * std::pow(annual_volatility, 2)) * dt_year + annual_volatility * std::sqrt(dt_year) * Z(gen));
+            double mid = book.get_mid(price);
+            auto process = [&](Agent& a, std::optional<Order> o, AgentStats& stats) { if (o) { o->owner = a.account; fill(*o, book.add_order(*o), stats); } };
+            for (auto& a : makers) process(a, a.act(mid, realized_vol, t, oid), s_make);
+            for (auto& a : fundamental) process(a, a.act_with_market(true_value, mid, t, oid), s_fund);
+            for (auto& a : noise) process(a, a.act(mid, realized_vol, t, oid), s_noise);
+            for (auto& a : momentum) process(a, a.act(mid, realized_vol, t, oid), s_mom);
+        }
+        if (price > 0) { double ret = std::log(price / last_price); realized_vol = 0.99 * realized_vol + 0.01 * std::abs(ret); }
+        last_price = price;
+    }
+};
+
+// Basket mode (START/SIM_SYMBOLS > 1): M constituent books match in parallel, then after a
+// per-tick barrier the index level is updated and the index book trades against it.
+// Symbol 0 is the index, symbol k the k-th constituent. Population counts apply to the
+// index book; each constituent gets 1/M of them (at least one of each).
+void run_basket(EngineInterface& engine, const SimConfig& config) {
+    const int M = config.num_symbols;
+    double annual_return = 0.10; double annual_volatility = 0.15;
+    double seconds_per_year = 252 * 6.5 * 60 * 60;
+    double dt_broadcast = 60.0; int sub_steps = 20; double dt_step = dt_broadcast / sub_steps;
+    int num_arbs = 20; if (const char* a = std::getenv("SIM_ARBS")) num_arbs = std::max(0, std::atoi(a));
+    int workers = std::min<int>(M, std::max(1u, std::thread::hardware_concurrency()));
+    if (const char* w = std::getenv("SIM_WORKERS")) workers = std::max(1, std::atoi(w));
+    auto per = [M](int n) { return std::max(1, n / M); };
+
+    SeedSource rd; std::mt19937 gen(rd());
+    std::vector<std::unique_ptr<Constituent>> cons; IndexBasket basket;
+    for (int i = 0; i < M; ++i) {
+        double p0 = std::uniform_real_distribution<>(20.0, 200.0)(gen);
+        auto c = std::make_unique<Constituent>(i + 1, p0, rd());
+        for (int k = 0; k < per(config.num_makers); ++k) { c->makers.emplace_back(rd()); c->makers.back().account = c->ledger.add_account(AgentClass::MAKER); }
+        for (int k = 0; k < per(config.num_fundamental); ++k) { c->fundamental.emplace_back(rd()); c->fundamental.back().account = c->ledger.add_account(AgentClass::FUNDAMENTAL); }
+        for (int k = 0; k < per(config.num_momentum); ++k) { c->momentum.emplace_back(rd(), p0); c->momentum.back().account = c->ledger.add_account(AgentClass::MOMENTUM); }
+        for (int k = 0; k < per(config.num_noise); ++k) { c->noise.emplace_back(rd()); c->noise.back().account = c->ledger.add_account(AgentClass::NOISE); }
+        basket.add(100.0 / (M * p0), p0); // equal value weights, index starts at 100
+        cons.push_back(std::move(c));
+    }
+
+    LimitOrderBook book;
+    std::vector<MarketMaker> makers; for (int i=0; i<config.num_makers; ++i) makers.emplace_back(rd());
+    std::vector<NoiseTrader> noise; for (int i=0; i<config.num_noise; ++i) noise.emplace_back(rd());
+    std::vector<MomentumTrader> momentum; for (int i=0; i<config.num_momentum; ++i) momentum.emplace_back(rd(), basket.level);
+    std::vector<FundamentalTrader> fundamental; for (int i=0; i<config.num_fundamental; ++i) fundamental.emplace_back(rd());
+    std::vector<IndexArbitrageur> arbs; for (int i=0; i<num_arbs; ++i) arbs.emplace_back(rd());
+    AgentLedger ledger; UserAccounts users;
+    for (auto& a : makers) a.account = ledger.add_account(AgentClass::MAKER);
+    for (auto& a : fundamental) a.account = ledger.add_account(AgentClass::FUNDAMENTAL);
+    for (auto& a : momentum) a.account = ledger.add_account(AgentClass::MOMENTUM);
+    for (auto& a : noise) a.account = ledger.add_account(AgentClass::NOISE);
+    // Arbitrageurs trade toward fair value, so they report with the fundamental class.
+    for (auto& a : arbs) { a.account = ledger.add_account(AgentClass::FUNDAMENTAL); for (auto& c : cons) a.leg_account.push_back(c->ledger.add_account(AgentClass::FUNDAMENTAL)); }
+    double time = 0.0, price = basket.level, realized_vol = 0.005, vol_alpha = 0.01, last_price = price;
+    uint64_t oid = 1;
+    AgentStats s_fund, s_mom, s_make, s_noise, s_user; int tick_count = 0; uint32_t publish_volume = 0; // traded since the last publish
+
+    ShardPool pool(workers);
+    std::cout << "Index Basket Engine Started: " << M << " constituents on " << pool.size() << " workers." << std::endl;
+    PhaseTracer::name_thread("engine");
+
+    while (true) {
+        auto start_tick = std::chrono::steady_clock::now();
+        std::vector<UserOrder> user_orders;
+        int status;
+        { SIM_TRACE("checkCommands"); status = engine.checkCommands(user_orders); }
+        if (status == -2) break;
+
+        uint32_t tick_volume = 0;
+        for (auto& u : user_orders) {
+            uint32_t sym = u.cancel_id ? (uint32_t)(u.cancel_id >> SYMBOL_ID_SHIFT) : u.symbol;
+            if (sym >= 1 && sym <= (uint32_t)M) { cons[sym - 1]->inbox.push_back(u); continue; }
+            if (u.cancel_id) { users.cancel(u.user, u.cancel_id, book); continue; }
+            Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL, users.ledger_account(u.user, ledger)};
+            auto trades = book.add_order(o);
+            for (auto& t : trades) { tick_volume += t.quantity; price = t.price; s_user.add(u.is_buy, t.quantity); ledger.on_fill(t); }
+            users.on_trades(o, trades);
+        }
+
+        // Parallel phase: constituents match independently, then barrier
+        { SIM_TRACE("constituents"); pool.for_each_shard(M, [&](size_t i) { cons[i]->step(time, dt_step, sub_steps, annual_return, annual_volatility, seconds_per_year); }); }
+        { SIM_TRACE("basket"); for (int i = 0; i < M; ++i) basket.update(i, cons[i]->book.get_mid(cons[i]->price)); if (tick_count % 1000 == 0) basket.resum(); }
+
+        auto hedge = [&](IndexArbitrageur& a, Side index_side, uint32_t filled) {
+            Side s = index_side == Side::BUY ? Side::SELL : Side::BUY;
+            for (int i = 0; i < M; ++i) {
+                Constituent& c = *cons[i];
+                uint32_t q = (uint32_t)std::llround(filled * basket.weight[i]); if (q == 0) continue;
+                double mid = c.book.get_mid(c.price);
+                Order o = {c.oid++, time, s == Side::BUY ? mid * 1.002 : mid * 0.998, q, s, a.leg_account[i]};
+                c.fill(o, c.book.add_order(o), c.s_fund);
+                c.book.cancel(o.id);
+                basket.update(i, c.book.get_mid(c.price));
+            }
+        };
+
+        for (int s = 0; s < sub_steps; ++s) {
+            SIM_TRACE("index_step");
+            time += dt_step;
+            double true_value = basket.level;
+            double mid = book.get_mid(price);
+
+            auto process = [&](Agent& a, std::optional<Order> o, AgentStats& stats) -> uint32_t {
+                uint32_t filled = 0;
+                if (o) {
+                    o->owner = a.account;
+                    auto trades = book.add_order(*o);
+                    for (auto& t : trades) { tick_volume += t.quantity; price = t.price; filled += t.quantity; stats.add(o->side == Side::BUY, t.quantity); ledger.on_fill(t); }
+                    users.on_trades(*o, trades);
+                }
+                return filled;
+            };
+            for (auto& a : makers) process(a, a.act(mid, realized_vol, time, oid), s_make);
+            for (auto& a : fundamental) process(a, a.act_with_market(true_value, mid, time, oid), s_fund);
+            for (auto& a : noise) process(a, a.act(mid, realized_vol, time, oid), s_noise);
+            for (auto& a : momentum) process(a, a.act(mid, realized_vol, time, oid), s_mom);
+            for (auto& a : arbs) {
+                auto o = a.act_with_index(basket.level, book.get_mid(price), time, oid);
+                if (!o) continue;
+                uint32_t filled = process(a, o, s_fund);
+                book.cancel(o->id);
+                if (filled) hedge(a, o->side, filled);
+            }
+        }
+
+        if (price > 0) { double ret = std::log(price / last_price); realized_vol = (1 - vol_alpha) * realized_vol + vol_alpha * std::abs(ret); }
+        last_price = price;
+        publish_volume += tick_volume;
+        for (auto& c : cons) c->publish_volume += c->tick_volume; // after the hedges
+
+        if (++tick_count % publishInterval() == 0) {
+            SIM_TRACE("publish");
+            engine.broadcastSentiment(s_fund.buy_vol, s_fund.sell_vol, s_mom.buy_vol, s_mom.sell_vol, s_make.buy_vol, s_make.sell_vol, s_noise.buy_vol, s_noise.sell_vol, s_user.buy_vol, s_user.sell_vol);
+            engine.broadcastData(price, publish_volume);
+            engine.broadcastPnl(ledger.class_pnl(price), ledger.leaderboard(5, price));
+            users.sweep(book); users.publish(ledger, price, [&](const AccountSnapshot& a) { engine.broadcastAccount(a); });
+            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset(); publish_volume = 0;
+            for (auto& c : cons) {
+                engine.setSymbol(c->symbol);
+                engine.broadcastSentiment(c->s_fund.buy_vol, c->s_fund.sell_vol, c->s_mom.buy_vol, c->s_mom.sell_vol, c->s_make.buy_vol, c->s_make.sell_vol, c->s_noise.buy_vol, c->s_noise.sell_vol, c->s_user.buy_vol, c->s_user.sell_vol);
+                engine.broadcastData(c->price, c->publish_volume);
+                c->users.sweep(c->book); c->users.publish(c->ledger, c->price, [&](const AccountSnapshot& a) { engine.broadcastAccount(a); });
+                c->s_fund.reset(); c->s_mom.reset(); c->s_make.reset(); c->s_noise.reset(); c->s_user.reset(); c->publish_volume = 0;
+            }
+            engine.setSymbol(-1);
+        }
+        {
+            SIM_TRACE("broadcastFill");
+            users.drain_fills([&](const UserFill& f) { engine.broadcastFill(f); });
+            for (auto& c : cons) { engine.setSymbol(c->symbol); c->users.drain_fills([&](const UserFill& f) { engine.broadcastFill(f); }); }
+        }
+        engine.setSymbol(-1);
+        { SIM_TRACE("recordTick"); engine.recordTick(time, price, tick_volume); }
+        engine.waitForNextTick(start_tick);
+    }
+    if (PhaseTracer::enabled) PhaseTracer::instance().dump(); // on STOP
+}
+
 int main() {
-    EngineInterface engine; SimConfig config = engine.waitForStart(); LimitOrderBook book;
+    EngineInterface engine; SimConfig config = engine.waitForStart();
+    if (config.num_symbols > 1) { run_basket(engine, config); return 0; }
+    LimitOrderBook book;
     
     double annual_return = 0.10; double annual_volatility = 0.15; // Moderate
     double seconds_per_year = 252 * 6.5 * 60 * 60; 
@@ -124,38 +306,43 @@ int main() {
     // Sub-steps for smoother index simulation
     double dt_broadcast = 60.0; int sub_steps = 20; double dt_step = dt_broadcast / sub_steps;
 
-    std::random_device rd;
+    SeedSource rd;
     std::vector<MarketMaker> makers; for (int i=0; i<config.num_makers; ++i) makers.emplace_back(rd());
     std::vector<NoiseTrader> noise; for (int i=0; i<config.num_noise; ++i) noise.emplace_back(rd());
     std::vector<MomentumTrader> momentum; for (int i=0; i<config.num_momentum; ++i) momentum.emplace_back(rd(), 100.0);
     std::vector<FundamentalTrader> fundamental; for (int i=0; i<config.num_fundamental; ++i) fundamental.emplace_back(rd());
+    AgentLedger ledger; UserAccounts users;
+    for (auto& a : makers) a.account = ledger.add_account(AgentClass::MAKER);
+    for (auto& a : fundamental) a.account = ledger.add_account(AgentClass::FUNDAMENTAL);
+    for (auto& a : momentum) a.account = ledger.add_account(AgentClass::MOMENTUM);
+    for (auto& a : noise) a.account = ledger.add_account(AgentClass::NOISE);
     double time = 0.0, price = 100.0, true_value = 100.0, realized_vol = 0.005, vol_alpha = 0.01, last_price = price;
     uint64_t oid = 1;
     std::mt19937 gen(rd()); std::normal_distribution<> Z(0.0, 1.0);
-    AgentStats s_fund, s_mom, s_make, s_noise, s_user; int tick_count = 0;
+    AgentStats s_fund, s_mom, s_make, s_noise, s_user; int tick_count = 0; uint32_t publish_volume = 0; // traded since the last publish
 
     std::cout << "Moderate Engine Started." << std::endl;
+    PhaseTracer::name_thread("engine");
 
     while (true) {
         auto start_tick = std::chrono::steady_clock::now();
         std::vector<UserOrder> user_orders; 
-        if (!engine.checkCommands(user_orders)) break;
+        int status;
+        { SIM_TRACE("checkCommands"); status = engine.checkCommands(user_orders); }
+        if (status == -2) break;
 
         uint32_t tick_volume = 0;
 
         for(auto& u : user_orders) {
-            Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL};
+            if (u.cancel_id) { users.cancel(u.user, u.cancel_id, book); continue; }
+            Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL, users.ledger_account(u.user, ledger)};
             auto trades = book.add_order(o);
-            uint32_t filled_qty = 0; double total_val = 0;
-            
-            for(auto& t : trades) { 
-                tick_volume += t.quantity; price = t.price; s_user.add(u.is_buy, t.quantity);
-                filled_qty += t.quantity; total_val += t.quantity * t.price;
-            }
-            if(filled_qty > 0) engine.broadcastTrade("USER", u.is_buy, filled_qty, total_val/filled_qty);
+            for(auto& t : trades) { tick_volume += t.quantity; price = t.price; s_user.add(u.is_buy, t.quantity); ledger.on_fill(t); }
+            users.on_trades(o, trades);
         }
 
         for (int s = 0; s < sub_steps; ++s) {
+            SIM_TRACE("index_step");
             time += dt_step;
             double dt_year = dt_step / seconds_per_year;
             double drift = (annual_return - 0.5 * std::pow(annual_volatility, 2)) * dt_year;
@@ -163,30 +350,39 @@ int main() {
             true_value *= std::exp(drift + shock);
             double mid = book.get_mid(price);
 
-            auto process = [&](std::optional<Order> o, AgentStats& stats) {
+            auto process = [&](Agent& a, std::optional<Order> o, AgentStats& stats) {
                 if (o) {
+                    o->owner = a.account;
                     auto trades = book.add_order(*o);
                     for (auto& t : trades) { 
-                        tick_volume += t.quantity; price = t.price; stats.add(o->side == Side::BUY, t.quantity);
+                        tick_volume += t.quantity; price = t.price; stats.add(o->side == Side::BUY, t.quantity); ledger.on_fill(t);
                     }
+                    users.on_trades(*o, trades);
                 }
             };
-            for (auto& a : makers) process(a.act(mid, realized_vol, time, oid), s_make);
-            for (auto& a : fundamental) process(a.act_with_market(true_value, mid, time, oid), s_fund);
-            for (auto& a : noise) process(a.act(mid, realized_vol, time, oid), s_noise);
-            for (auto& a : momentum) process(a.act(mid, realized_vol, time, oid), s_mom);
+            for (auto& a : makers) process(a, a.act(mid, realized_vol, time, oid), s_make);
+            for (auto& a : fundamental) process(a, a.act_with_market(true_value, mid, time, oid), s_fund);
+            for (auto& a : noise) process(a, a.act(mid, realized_vol, time, oid), s_noise);
+            for (auto& a : momentum) process(a, a.act(mid, realized_vol, time, oid), s_mom);
         }
 
         if (price > 0) { double ret = std::log(price / last_price); realized_vol = (1 - vol_alpha) * realized_vol + vol_alpha * std::abs(ret); }
         last_price = price;
+        publish_volume += tick_volume;
 
         // Throttled Broadcast
-        if (++tick_count % 10 == 0) {
+        if (++tick_count % publishInterval() == 0) {
+             SIM_TRACE("publish");
              engine.broadcastSentiment(s_fund.buy_vol, s_fund.sell_vol, s_mom.buy_vol, s_mom.sell_vol, s_make.buy_vol, s_make.sell_vol, s_noise.buy_vol, s_noise.sell_vol, s_user.buy_vol, s_user.sell_vol);
-             engine.broadcastData(price, tick_volume);
-            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset();
+             engine.broadcastData(price, publish_volume);
+             engine.broadcastPnl(ledger.class_pnl(price), ledger.leaderboard(5, price));
+             users.sweep(book); users.publish(ledger, price, [&](const AccountSnapshot& a) { engine.broadcastAccount(a); });
+            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset(); publish_volume = 0;
         }
-        std::this_thread::sleep_until(start_tick + std::chrono::milliseconds(20)); // FAST SIM LOOP (50Hz)
+        { SIM_TRACE("broadcastFill"); users.drain_fills([&](const UserFill& f) { engine.broadcastFill(f); }); }
+        { SIM_TRACE("recordTick"); engine.recordTick(time, price, tick_volume); }
+        engine.waitForNextTick(start_tick);
     }
+    if (PhaseTracer::enabled) PhaseTracer::instance().dump(); // on STOP
     return 0;
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include "EngineInterface.hpp"
+#include "LimitOrderBook.hpp"
+#include "AgentLedger.hpp"
+#include "PhaseTrace.hpp"
 #include <vector>
 #include <queue>
 #include <unordered_map>
@@ -11,64 +14,7 @@
 #include <chrono>
 #include <thread>
 
-enum class Side { BUY, SELL };
-struct Order { uint64_t id; double timestamp; double price; uint32_t quantity; Side side; };
-struct Trade { double price; uint32_t quantity; double timestamp; };
-
-class LimitOrderBook {
-private:
-    std::unordered_map<uint64_t, Order> active_orders;
-    struct askComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price > b.price : a.timestamp > b.timestamp; } };
-    struct bidComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price < b.price : a.timestamp > b.timestamp; } };
-public:
-    std::priority_queue<Order, std::vector<Order>, askComp> askHeap;
-    std::priority_queue<Order, std::vector<Order>, bidComp> bidHeap;
-    double last_traded_price;
-
-    LimitOrderBook() { active_orders.reserve(500000); last_traded_price = 100.0; }
-
-    void decay(double percentage, std::mt19937& gen) {
-        if (active_orders.empty()) return;
-        std::vector<uint64_t> to_delete;
-        std::uniform_real_distribution<> dist(0.0, 1.0);
-        for (auto const& [id, order] : active_orders) { if (dist(gen) < percentage) to_delete.push_back(id); }
-        for (uint64_t id : to_delete) active_orders.erase(id);
-    }
-
-    std::vector<Trade> add_order(Order order) {
-        std::vector<Trade> trades;
-        if (order.side == Side::SELL) {
-            while (order.quantity > 0 && !bidHeap.empty()) {
-                if (!active_orders.count(bidHeap.top().id)) { bidHeap.pop(); continue; }
-                const Order& best = bidHeap.top();
-                if (best.price < order.price) break;
-                uint32_t qty = std::min(best.quantity, order.quantity);
-                trades.push_back({best.price, qty, order.timestamp});
-                last_traded_price = best.price;
-                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; bidHeap.pop(); bidHeap.push(updated); } 
-                else { active_orders.erase(best.id); bidHeap.pop(); }
-                order.quantity -= qty;
-            }
-            if (order.quantity > 0) { active_orders[order.id] = order; askHeap.push(order); }
-        } else {
-            while (order.quantity > 0 && !askHeap.empty()) {
-                if (!active_orders.count(askHeap.top().id)) { askHeap.pop(); continue; }
-                const Order& best = askHeap.top();
-                if (best.price > order.price) break;
-                uint32_t qty = std::min(best.quantity, order.quantity);
-                trades.push_back({best.price, qty, order.timestamp});
-                last_traded_price = best.price;
-                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; askHeap.pop(); askHeap.push(updated); } 
-                else { active_orders.erase(best.id); askHeap.pop(); }
-                order.quantity -= qty;
-            }
-            if (order.quantity > 0) { active_orders[order.id] = order; bidHeap.push(order); }
-        }
-        return trades;
-    }
-};
-
-class Agent { public: virtual ~Agent() = default; virtual std::optional<Order> act(double ref_price, double time, uint64_t& id) = 0; virtual std::string get_name() = 0; };
+class Agent { public: virtual ~Agent() = default; virtual std::optional<Order> act(double ref_price, double time, uint64_t& id) = 0; virtual std::string get_name() = 0; uint32_t account = 0; };
 
 class MarketMaker : public Agent {
     std::mt19937 gen; std::exponential_distribution<> wake_dist; std::uniform_int_distribution<> size_dist; double next_act_time;
@@ -142,61 +88,78 @@ int main() {
     EngineInterface engine; SimConfig config = engine.waitForStart(); LimitOrderBook book;
     double time = 0.0, dt = 60.0, true_value = 100.0; uint64_t oid = 1;
     
-    std::random_device rd; std::mt19937 gen(rd()); std::normal_distribution<> Z(0.0, 1.0);
+    SeedSource rd; std::mt19937 gen(rd()); std::normal_distribution<> Z(0.0, 1.0);
     std::vector<MarketMaker> makers; for (int i = 0; i < config.num_makers; ++i) makers.emplace_back(rd());
     std::vector<FundamentalTrader> fundamental; for (int i = 0; i < config.num_fundamental; ++i) fundamental.emplace_back(rd());
     std::vector<NoiseTrader> noise; for (int i = 0; i < config.num_noise; ++i) noise.emplace_back(rd());
     std::vector<MomentumTrader> momentum; for (int i = 0; i < config.num_momentum; ++i) momentum.emplace_back(rd(), 100.0);
+    AgentLedger ledger; UserAccounts users;
+    for (auto& a : makers) a.account = ledger.add_account(AgentClass::MAKER);
+    for (auto& a : fundamental) a.account = ledger.add_account(AgentClass::FUNDAMENTAL);
+    for (auto& a : momentum) a.account = ledger.add_account(AgentClass::MOMENTUM);
+    for (auto& a : noise) a.account = ledger.add_account(AgentClass::NOISE);
     
-    AgentStats s_fund, s_mom, s_make, s_noise, s_user; int tick_count = 0;
+    AgentStats s_fund, s_mom, s_make, s_noise, s_user; int tick_count = 0; uint32_t publish_volume = 0; // traded since the last publish
 
     std::cout << "Most Volatile Engine Started." << std::endl;
+    PhaseTracer::name_thread("engine");
 
     while (true) { 
         auto start_tick = std::chrono::steady_clock::now();
         std::vector<UserOrder> user_orders; 
-        if (!engine.checkCommands(user_orders)) break;
+        int status;
+        { SIM_TRACE("checkCommands"); status = engine.checkCommands(user_orders); }
+        if (status == -2) break;
 
         uint32_t tick_volume = 0;
         
-        for(auto& u : user_orders) {
-            Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL};
-            auto trades = book.add_order(o);
-            uint32_t filled_qty = 0; double total_val = 0.0;
-            for(auto& t : trades) { 
-                tick_volume += t.quantity; book.last_traded_price = t.price; s_user.add(u.is_buy, t.quantity);
-                filled_qty += t.quantity; total_val += (t.price * t.quantity);
+        if (!user_orders.empty()) {
+            SIM_TRACE("user_orders");
+            for(auto& u : user_orders) {
+                if (u.cancel_id) { users.cancel(u.user, u.cancel_id, book); continue; }
+                Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL, users.ledger_account(u.user, ledger)};
+                auto trades = book.add_order(o);
+                for(auto& t : trades) { tick_volume += t.quantity; book.last_traded_price = t.price; s_user.add(u.is_buy, t.quantity); ledger.on_fill(t); }
+                users.on_trades(o, trades);
             }
-            if(filled_qty > 0) engine.broadcastTrade("USER", u.is_buy, filled_qty, total_val/filled_qty);
         }
 
-        double shock = 0.01 * Z(gen); true_value *= std::exp(shock); 
+        { SIM_TRACE("fundamentals"); double shock = 0.01 * Z(gen); true_value *= std::exp(shock); }
         double ref_price = book.last_traded_price;
 
-        auto process_agent = [&](std::optional<Order> o, AgentStats& stats) {
+        auto process_agent = [&](Agent& a, std::optional<Order> o, AgentStats& stats) {
             if (o) {
+                o->owner = a.account;
                 auto trades = book.add_order(*o);
                 for(auto& t : trades) {
-                    tick_volume += t.quantity; book.last_traded_price = t.price; stats.add(o->side == Side::BUY, t.quantity);
+                    tick_volume += t.quantity; book.last_traded_price = t.price; stats.add(o->side == Side::BUY, t.quantity); ledger.on_fill(t);
                 }
+                users.on_trades(*o, trades);
             }
         };
 
-        for (auto& a : makers) process_agent(a.act(ref_price, time, oid), s_make);
-        for (auto& a : fundamental) process_agent(a.act_with_market(true_value, ref_price, time, oid), s_fund);
-        for (auto& a : noise) process_agent(a.act(ref_price, time, oid), s_noise);
-        for (auto& a : momentum) process_agent(a.act(ref_price, time, oid), s_mom);
+        { SIM_TRACE("makers"); for (auto& a : makers) process_agent(a, a.act(ref_price, time, oid), s_make); }
+        { SIM_TRACE("fundamental"); for (auto& a : fundamental) process_agent(a, a.act_with_market(true_value, ref_price, time, oid), s_fund); }
+        { SIM_TRACE("noise"); for (auto& a : noise) process_agent(a, a.act(ref_price, time, oid), s_noise); }
+        { SIM_TRACE("momentum"); for (auto& a : momentum) process_agent(a, a.act(ref_price, time, oid), s_mom); }
         
+        publish_volume += tick_volume;
         // Throttled Broadcast (10 ticks ~ 200ms)
-        if (++tick_count % 10 == 0) {
-            book.decay(0.05, gen);
-            engine.broadcastSentiment(s_fund.buy_vol, s_fund.sell_vol, s_mom.buy_vol, s_mom.sell_vol, s_make.buy_vol, s_make.sell_vol, s_noise.buy_vol, s_noise.sell_vol, s_user.buy_vol, s_user.sell_vol);
-            engine.broadcastData(book.last_traded_price, tick_volume);
-            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset();
+        if (++tick_count % publishInterval() == 0) {
+            { SIM_TRACE("decay"); book.decay(0.05, gen); }
+            SIM_TRACE("publish");
+            { SIM_TRACE("broadcastSentiment"); engine.broadcastSentiment(s_fund.buy_vol, s_fund.sell_vol, s_mom.buy_vol, s_mom.sell_vol, s_make.buy_vol, s_make.sell_vol, s_noise.buy_vol, s_noise.sell_vol, s_user.buy_vol, s_user.sell_vol); }
+            { SIM_TRACE("broadcastData"); engine.broadcastData(book.last_traded_price, publish_volume); }
+            { SIM_TRACE("broadcastPnl"); engine.broadcastPnl(ledger.class_pnl(book.last_traded_price), ledger.leaderboard(5, book.last_traded_price)); }
+            { SIM_TRACE("broadcastAccount"); users.sweep(book); users.publish(ledger, book.last_traded_price, [&](const AccountSnapshot& a) { engine.broadcastAccount(a); }); }
+            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset(); publish_volume = 0;
         }
 
         time += dt;
-        std::this_thread::sleep_until(start_tick + std::chrono::milliseconds(20)); // Fast Sim Loop (50Hz)
+        { SIM_TRACE("broadcastFill"); users.drain_fills([&](const UserFill& f) { engine.broadcastFill(f); }); }
+        { SIM_TRACE("recordTick"); engine.recordTick(time, book.last_traded_price, tick_volume); }
+        engine.waitForNextTick(start_tick);
     }
+    if (PhaseTracer::enabled) PhaseTracer::instance().dump(); // on STOP
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "EngineInterface.hpp"
+#include "LimitOrderBook.hpp"
+#include "AgentLedger.hpp"
+#include "UserAccounts.hpp"
+#include "ShardPool.hpp"
+#include "FundamentalProcess.hpp"
+#include "VeryVolatileAgents.hpp"
+#include "PhaseTrace.hpp"
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Multi-symbol engine: N instruments, each with its own book and agent population
+// (VeryVolatileAgents.hpp, NORMAL phase); fundamentals are correlated across symbols (FundamentalProcess). Books are sharded across a ShardPool; agents may
+// hold legs on several symbols. All market data is tagged "S<symbol> ".
+
+constexpr uint32_t USER_GLOBAL_ID = UINT32_MAX;
+
+// Everything one symbol needs for a tick. A shard is only touched by its worker
+// during the parallel phase and by the main thread between barriers.
+struct SymbolShard {
+    uint32_t symbol; LimitOrderBook book;
+    double true_value = 100.0, price = 100.0, last_price = 100.0, realized_vol = 0.005, vol_alpha = 0.01;
+    uint64_t oid; uint32_t tick_volume = 0, publish_volume = 0; // publish_volume: since the last publish
+    std::vector<MarketMaker> makers; std::vector<FundamentalTrader> fundamental; std::vector<NoiseTrader> noise; std::vector<MomentumTrader> momentum;
+    MarketContext market; // agents read their phase here; multi-symbol runs stay NORMAL
+    AgentLedger ledger; UserAccounts users;
+    std::vector<uint32_t> global_id; // ledger account -> global agent id
+    AgentStats s_fund, s_mom, s_make, s_noise, s_user;
+    std::vector<UserOrder> inbox;
+
+    SymbolShard(uint32_t s) : symbol(s), book(50000), oid(((uint64_t)s << SYMBOL_ID_SHIFT) + 1) {}
+
+    template <class A> void add_leg(std::vector<A>& pop, A a, AgentClass c, uint32_t global) { a.market = &market; global_id.push_back(global); a.account = ledger.add_account(c); pop.push_back(std::move(a)); }
+
+    void step(double time) {
+        SIM_TRACE("shard");
+        tick_volume = 0;
+
+        for (auto& u : inbox) {
+            if (u.cancel_id) { users.cancel(u.user, u.cancel_id, book); continue; }
+            Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL, users.ledger_account(u.user, ledger)};
+            if (global_id.size() < ledger.size()) global_id.push_back(USER_GLOBAL_ID); // first order from this user
+            auto trades = book.add_order(o);
+            for (auto& t : trades) { tick_volume += t.quantity; price = t.price; s_user.add(u.is_buy, t.quantity); ledger.on_fill(t); }
+            users.on_trades(o, trades);
+        }
+        inbox.clear();
+
+        double mid = book.get_mid(price);
+
+        auto process = [&](Agent& a, std::optional<Order> o, AgentStats& stats) {
+            if (o) {
+                o->owner = a.account;
+                auto trades = book.add_order(*o);
+                for (auto& t : trades) { tick_volume += t.quantity; price = t.price; stats.add(o->side == Side::BUY, t.quantity); ledger.on_fill(t); }
+                users.on_trades(*o, trades);
+            }
+        };
+        { SIM_TRACE("makers"); for (auto& a : makers) process(a, a.act(mid, realized_vol, time, oid), s_make); }
+        { SIM_TRACE("fundamental"); for (auto& a : fundamental) process(a, a.act_with_market<MarketScenario::NORMAL>(true_value, mid, time, oid), s_fund); }
+        { SIM_TRACE("noise"); for (auto& a : noise) process(a, a.act(mid, realized_vol, time, oid), s_noise); }
+        { SIM_TRACE("momentum"); for (auto& a : momentum) process(a, a.act(mid, realized_vol, time, oid), s_mom); }
+
+        if (price > 0) { double ret = std::log(price / last_price); realized_vol = (1 - vol_alpha) * realized_vol + vol_alpha * std::abs(ret); }
+        last_price = price;
+        publish_volume += tick_volume;
+    }
+};
+
+int main() {
+    EngineInterface engine; SimConfig config = engine.waitForStart();
+    const int N = config.num_symbols;
+    int legs = 1; if (const char* k = std::getenv("SIM_SYMBOLS_PER_AGENT")) legs = std::max(1, std::min(N, std::atoi(k)));
+    int workers = std::min<int>(N, std::max(1u, std::thread::hardware_concurrency()));
+    if (const char* w = std::getenv("SIM_WORKERS")) workers = std::max(1, std::atoi(w));
+    double dt = 60.0;
+
+    SeedSource rd;
+    std::vector<std::unique_ptr<SymbolShard>> shards;
+    for (int s = 0; s < N; ++s) shards.push_back(std::make_unique<SymbolShard>(s));
+
+    // Fundamentals: market + sector factor model (SIM_SECTOR_SIZE consecutive symbols per
+    // sector). SIM_CORR_MODEL=cholesky factors the same correlation matrix explicitly.
+    double seconds_per_year = 252 * 6.5 * 60 * 60;
+    double market_corr = 0.3, sector_corr = 0.5; int sector_size = 10;
+    if (const char* c = std::getenv("SIM_MARKET_CORR")) market_corr = std::atof(c);
+    if (const char* c = std::getenv("SIM_SECTOR_CORR")) sector_corr = std::atof(c);
+    if (const char* c = std::getenv("SIM_SECTOR_SIZE")) sector_size = std::max(1, std::atoi(c));
+    FundamentalProcess fundamentals(N, 100.0, 0.28, 0.45, rd());
+    std::vector<int> sector_of(N); for (int s = 0; s < N; ++s) sector_of[s] = s / sector_size;
+    const char* model = std::getenv("SIM_CORR_MODEL");
+    bool factored = false;
+    if (model && std::string(model) == "cholesky") {
+        std::vector<double> corr(N * N);
+        for (int i = 0; i < N; ++i) for (int j = 0; j < N; ++j) corr[i * N + j] = i == j ? 1.0 : (sector_of[i] == sector_of[j] ? sector_corr : market_corr);
+        factored = fundamentals.set_correlation(corr);
+        if (!factored) std::cout << "Correlation matrix not positive definite, using factor model." << std::endl;
+    }
+    if (!factored) fundamentals.set_sectors(sector_of, market_corr, sector_corr);
+
+    // Population counts are per home symbol; each agent also trades the next legs-1 symbols.
+    uint32_t next_global = 0;
+    std::vector<AgentClass> global_class;
+    for (int h = 0; h < N; ++h) {
+        auto spawn = [&](int count, AgentClass c, auto&& add_leg) {
+            for (int i = 0; i < count; ++i) {
+                uint32_t g = next_global++; global_class.push_back(c);
+                for (int j = 0; j < legs; ++j) add_leg(*shards[(h + j) % N], g);
+            }
+        };
+        spawn(config.num_makers, AgentClass::MAKER, [&](SymbolShard& sh, uint32_t g) { sh.add_leg(sh.makers, MarketMaker(rd()), AgentClass::MAKER, g); });
+        spawn(config.num_fundamental, AgentClass::FUNDAMENTAL, [&](SymbolShard& sh, uint32_t g) { sh.add_leg(sh.fundamental, FundamentalTrader(rd()), AgentClass::FUNDAMENTAL, g); });
+        spawn(config.num_momentum, AgentClass::MOMENTUM, [&](SymbolShard& sh, uint32_t g) { sh.add_leg(sh.momentum, MomentumTrader(rd(), 100.0), AgentClass::MOMENTUM, g); });
+        spawn(config.num_noise, AgentClass::NOISE, [&](SymbolShard& sh, uint32_t g) { sh.add_leg(sh.noise, NoiseTrader(rd()), AgentClass::NOISE, g); });
+    }
+
+    ShardPool pool(workers);
+    double time = 0.0; int tick_count = 0;
+    std::vector<double> global_pnl(next_global);
+
+    std::cout << "Multi-Symbol Engine Started: " << N << " symbols on " << pool.size() << " workers." << std::endl;
+    PhaseTracer::name_thread("engine");
+
+    while (true) {
+        auto start_tick = std::chrono::steady_clock::now();
+        std::vector<UserOrder> user_orders;
+        int status;
+        { SIM_TRACE("checkCommands"); status = engine.checkCommands(user_orders); }
+        if (status == -2) break;
+        for (auto& u : user_orders) {
+            uint32_t sym = u.cancel_id ? (uint32_t)(u.cancel_id >> SYMBOL_ID_SHIFT) : u.symbol;
+            if (sym < (uint32_t)N) shards[sym]->inbox.push_back(u);
+        }
+
+        time += dt;
+        { SIM_TRACE("fundamentals"); fundamentals.step(dt / seconds_per_year); for (int s = 0; s < N; ++s) shards[s]->true_value = fundamentals[s]; }
+        { SIM_TRACE("shards"); pool.for_each_shard(N, [&](size_t i) { shards[i]->step(time); }); }
+
+        // Single-threaded publish phase: all shards are quiescent after the barrier
+        { SIM_TRACE("broadcastFill"); for (auto& sh : shards) { engine.setSymbol(sh->symbol); sh->users.drain_fills([&](const UserFill& f) { engine.broadcastFill(f); }); } }
+
+        if (++tick_count % publishInterval() == 0) {
+            SIM_TRACE("publish");
+            std::array<double, NUM_AGENT_CLASSES> class_pnl{};
+            std::fill(global_pnl.begin(), global_pnl.end(), 0.0);
+            for (auto& sh : shards) {
+                engine.setSymbol(sh->symbol);
+                engine.broadcastSentiment(sh->s_fund.buy_vol, sh->s_fund.sell_vol, sh->s_mom.buy_vol, sh->s_mom.sell_vol, sh->s_make.buy_vol, sh->s_make.sell_vol, sh->s_noise.buy_vol, sh->s_noise.sell_vol, sh->s_user.buy_vol, sh->s_user.sell_vol);
+                engine.broadcastData(sh->price, sh->publish_volume);
+                auto [spread, liq] = sh->book.get_metrics();
+                engine.broadcastMetrics(spread, liq);
+                sh->users.sweep(sh->book); sh->users.publish(sh->ledger, sh->price, [&](const AccountSnapshot& a) { engine.broadcastAccount(a); });
+                auto cp = sh->ledger.class_pnl(sh->price);
+                for (int c = 0; c < NUM_AGENT_CLASSES; ++c) class_pnl[c] += cp[c];
+                for (uint32_t a = 0; a < sh->ledger.size(); ++a) if (sh->global_id[a] != USER_GLOBAL_ID) global_pnl[sh->global_id[a]] += sh->ledger.pnl(a, sh->price);
+                sh->s_fund.reset(); sh->s_mom.reset(); sh->s_make.reset(); sh->s_noise.reset(); sh->s_user.reset(); sh->publish_volume = 0;
+            }
+            // Leaderboard over whole agents (all legs), untagged
+            std::vector<LedgerEntry> leaders; leaders.reserve(global_pnl.size());
+            for (uint32_t g = 0; g < global_pnl.size(); ++g) leaders.push_back({g, global_class[g], global_pnl[g]});
+            size_t n = std::min<size_t>(5, leaders.size());
+            std::partial_sort(leaders.begin(), leaders.begin() + n, leaders.end(), [](const LedgerEntry& x, const LedgerEntry& y) { return x.pnl > y.pnl; });
+            leaders.resize(n);
+            engine.setSymbol(-1);
+            engine.broadcastPnl(class_pnl, leaders);
+        }
+        engine.setSymbol(-1);
+        { SIM_TRACE("recordTick"); engine.recordTick(time, shards[0]->price, shards[0]->tick_volume); }
+        engine.waitForNextTick(start_tick);
+    }
+    if (PhaseTracer::enabled) PhaseTracer::instance().dump(); // on STOP
+    return 0;
+}
@@ -1,4 +1,7 @@
 #include "EngineInterface.hpp"
+#include "LimitOrderBook.hpp"
+#include "AgentLedger.hpp"
+#include "PhaseTrace.hpp"
 #include <vector>
 #include <queue>
 #include <unordered_map>
@@ -11,46 +14,7 @@
 #include <chrono>
 #include <thread>
 
-enum class Side { BUY, SELL };
-struct Order { uint64_t id; double timestamp; double price; uint32_t quantity; Side side; };
-struct Trade { double price; uint32_t quantity; double timestamp; };
-
-class LimitOrderBook {
-private:
-    std::unordered_map<uint64_t, Order> active_orders;
-    struct askComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price > b.price : a.timestamp > b.timestamp; } };
-    struct bidComp { bool operator()(const Order& a, const Order& b) const { return a.price != b.price ? a.price < b.price : a.timestamp > b.timestamp; } };
-public:
-    std::priority_queue<Order, std::vector<Order>, askComp> askHeap;
-    std::priority_queue<Order, std::vector<Order>, bidComp> bidHeap;
-    LimitOrderBook() { active_orders.reserve(500000); }
-    double get_mid(double fallback) { if (askHeap.empty() || bidHeap.empty()) return fallback; return 0.5 * (askHeap.top().price + bidHeap.top().price); }
-    std::vector<Trade> add_order(Order order) {
-        std::vector<Trade> trades;
-        if (order.side == Side::SELL) {
-            while (order.quantity > 0 && !bidHeap.empty()) {
-                if (!active_orders.count(bidHeap.top().id)) { bidHeap.pop(); continue; }
-                const Order& best = bidHeap.top(); if (best.price < order.price) break;
-                uint32_t qty = std::min(best.quantity, order.quantity); trades.push_back({best.price, qty, order.timestamp});
-                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; bidHeap.pop(); bidHeap.push(updated); } else { active_orders.erase(best.id); bidHeap.pop(); }
-                order.quantity -= qty;
-            }
-            if (order.quantity > 0) { active_orders[order.id] = order; askHeap.push(order); }
-        } else {
-            while (order.quantity > 0 && !askHeap.empty()) {
-                if (!active_orders.count(askHeap.top().id)) { askHeap.pop(); continue; }
-                const Order& best = askHeap.top(); if (best.price > order.price) break;
-                uint32_t qty = std::min(best.quantity, order.quantity); trades.push_back({best.price, qty, order.timestamp});
-                if (best.quantity > qty) { Order updated = best; updated.quantity -= qty; active_orders[best.id] = updated; askHeap.pop(); askHeap.push(updated); } else { active_orders.erase(best.id); askHeap.pop(); }
-                order.quantity -= qty;
-            }
-            if (order.quantity > 0) { active_orders[order.id] = order; bidHeap.push(order); }
-        }
-        return trades;
-    }
-};
-
-class Agent { public: virtual ~Agent() = default; virtual std::optional<Order> act(double mid, double vol, double time, uint64_t& id) = 0; virtual std::string get_name() = 0; };
+class Agent { public: virtual ~Agent() = default; virtual std::optional<Order> act(double mid, double vol, double time, uint64_t& id) = 0; virtual std::string get_name() = 0; uint32_t account = 0; };
 class MarketMaker : public Agent {
     std::mt19937 gen; std::exponential_distribution<> wake_dist; std::uniform_int_distribution<> size_dist; std::uniform_real_distribution<> spread_jitter; double next_act_time;
 public:
@@ -119,68 +83,88 @@ int main() {
     double annual_return = 0.28; double annual_volatility = 0.45; 
     double seconds_per_year = 252 * 6.5 * 60 * 60; double dt = 60.0; 
     
-    std::random_device rd; std::mt19937 gen(rd()); std::normal_distribution<> Z(0.0, 1.0);
+    SeedSource rd; std::mt19937 gen(rd()); std::normal_distribution<> Z(0.0, 1.0);
     std::vector<MarketMaker> makers; for (int i=0; i<config.num_makers; ++i) makers.emplace_back(rd());
     std::vector<NoiseTrader> noise; for (int i=0; i<config.num_noise; ++i) noise.emplace_back(rd());
     std::vector<MomentumTrader> momentum; for (int i=0; i<config.num_momentum; ++i) momentum.emplace_back(rd(), 100.0);
     std::vector<FundamentalTrader> fundamental; for (int i=0; i<config.num_fundamental; ++i) fundamental.emplace_back(rd());
+    AgentLedger ledger; UserAccounts users;
+    for (auto& a : makers) a.account = ledger.add_account(AgentClass::MAKER);
+    for (auto& a : fundamental) a.account = ledger.add_account(AgentClass::FUNDAMENTAL);
+    for (auto& a : momentum) a.account = ledger.add_account(AgentClass::MOMENTUM);
+    for (auto& a : noise) a.account = ledger.add_account(AgentClass::NOISE);
     
     double time = 0.0; double price = 100.0; double true_value = 100.0; double realized_vol = 0.005; double vol_alpha = 0.01; double last_price = price;
     uint64_t oid = 1;
-    AgentStats s_fund, s_mom, s_make, s_noise, s_user; int tick_count = 0;
+    AgentStats s_fund, s_mom, s_make, s_noise, s_user; int tick_count = 0; uint32_t publish_volume = 0; // traded since the last publish
 
     std::cout << "Very Volatile Engine Started." << std::endl;
+    PhaseTracer::name_thread("engine");
 
     while (true) {
         auto start_tick = std::chrono::steady_clock::now();
         std::vector<UserOrder> user_orders; 
-        if (!engine.checkCommands(user_orders)) break;
+        int status;
+        { SIM_TRACE("checkCommands"); status = engine.checkCommands(user_orders); }
+        if (status == -2) break;
 
         uint32_t tick_volume = 0; 
 
         // 1. Process User
-        for(auto& u : user_orders) {
-            Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL};
-            auto trades = book.add_order(o);
-            uint32_t filled_qty = 0; double total_val = 0;
-            for(auto& t : trades) { 
-                tick_volume += t.quantity; price = t.price; s_user.add(u.is_buy, t.quantity);
-                filled_qty += t.quantity; total_val += t.quantity * t.price;
+        if (!user_orders.empty()) {
+            SIM_TRACE("user_orders");
+            for(auto& u : user_orders) {
+                if (u.cancel_id) { users.cancel(u.user, u.cancel_id, book); continue; }
+                Order o = {oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL, users.ledger_account(u.user, ledger)};
+                auto trades = book.add_order(o);
+                for(auto& t : trades) { tick_volume += t.quantity; price = t.price; s_user.add(u.is_buy, t.quantity); ledger.on_fill(t); }
+                users.on_trades(o, trades);
             }
-            if(filled_qty > 0) engine.broadcastTrade("USER", u.is_buy, filled_qty, total_val / filled_qty);
         }
 
         // 2. Fast Simulation (50Hz)
         time += dt;
-        double dt_year = dt / seconds_per_year;
-        double drift = (annual_return - 0.5 * std::pow(annual_volatility, 2)) * dt_year;
-        double shock = annual_volatility * std::sqrt(dt_year) * Z(gen);
-        true_value *= std::exp(drift + shock);
+        {
+            SIM_TRACE("fundamentals");
+            double dt_year = dt / seconds_per_year;
+            double drift = (annual_return - 0.5 * std::pow(annual_volatility, 2)) * dt_year;
+            double shock = annual_volatility * std::sqrt(dt_year) * Z(gen);
+            true_value *= std::exp(drift + shock);
+        }
         double mid = book.get_mid(price);
 
-        auto process = [&](std::optional<Order> o, AgentStats& stats) {
+        auto process = [&](Agent& a, std::optional<Order> o, AgentStats& stats) {
             if (o) {
+                o->owner = a.account;
                 auto trades = book.add_order(*o);
                 for (auto& t : trades) { 
-                    tick_volume += t.quantity; price = t.price; stats.add(o->side == Side::BUY, t.quantity); 
+                    tick_volume += t.quantity; price = t.price; stats.add(o->side == Side::BUY, t.quantity); ledger.on_fill(t); 
                 }
+                users.on_trades(*o, trades);
             }
         };
-        for (auto& a : makers) process(a.act(mid, realized_vol, time, oid), s_make);
-        for (auto& a : fundamental) process(a.act_with_market(true_value, mid, time, oid), s_fund);
-        for (auto& a : noise) process(a.act(mid, realized_vol, time, oid), s_noise);
-        for (auto& a : momentum) process(a.act(mid, realized_vol, time, oid), s_mom);
+        { SIM_TRACE("makers"); for (auto& a : makers) process(a, a.act(mid, realized_vol, time, oid), s_make); }
+        { SIM_TRACE("fundamental"); for (auto& a : fundamental) process(a, a.act_with_market(true_value, mid, time, oid), s_fund); }
+        { SIM_TRACE("noise"); for (auto& a : noise) process(a, a.act(mid, realized_vol, time, oid), s_noise); }
+        { SIM_TRACE("momentum"); for (auto& a : momentum) process(a, a.act(mid, realized_vol, time, oid), s_mom); }
 
         if (price > 0) { double ret = std::log(price / last_price); realized_vol = (1 - vol_alpha) * realized_vol + vol_alpha * std::abs(ret); }
         last_price = price;
+        publish_volume += tick_volume;
         
         // 3. Throttled Broadcast (5Hz)
-        if (++tick_count % 10 == 0) {
-            engine.broadcastSentiment(s_fund.buy_vol, s_fund.sell_vol, s_mom.buy_vol, s_mom.sell_vol, s_make.buy_vol, s_make.sell_vol, s_noise.buy_vol, s_noise.sell_vol, s_user.buy_vol, s_user.sell_vol);
-            engine.broadcastData(price, tick_volume);
-            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset();
+        if (++tick_count % publishInterval() == 0) {
+            SIM_TRACE("publish");
+            { SIM_TRACE("broadcastSentiment"); engine.broadcastSentiment(s_fund.buy_vol, s_fund.sell_vol, s_mom.buy_vol, s_mom.sell_vol, s_make.buy_vol, s_make.sell_vol, s_noise.buy_vol, s_noise.sell_vol, s_user.buy_vol, s_user.sell_vol); }
+            { SIM_TRACE("broadcastData"); engine.broadcastData(price, publish_volume); }
+            { SIM_TRACE("broadcastPnl"); engine.broadcastPnl(ledger.class_pnl(price), ledger.leaderboard(5, price)); }
+            { SIM_TRACE("broadcastAccount"); users.sweep(book); users.publish(ledger, price, [&](const AccountSnapshot& a) { engine.broadcastAccount(a); }); }
+            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset(); publish_volume = 0;
         }
-        std::this_thread::sleep_until(start_tick + std::chrono::milliseconds(20)); // Fast Sim Loop
+        { SIM_TRACE("broadcastFill"); users.drain_fills([&](const UserFill& f) { engine.broadcastFill(f); }); }
+        { SIM_TRACE("recordTick"); engine.recordTick(time, price, tick_volume); }
+        engine.waitForNextTick(start_tick);
     }
+    if (PhaseTracer::enabled) PhaseTracer::instance().dump(); // on STOP
     return 0;
 }
\ No newline at end of file
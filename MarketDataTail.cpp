@@ -0,0 +1,46 @@
+#include "ShmRing.hpp"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+// Prints an engine's shared-memory feed (SIM_SHM=<name>) in the ZMQ text format, prefixed
+// with "S<n> " for symbol-tagged records, and reports overruns on exit.
+// Usage: md_tail <name> [--from-now] [--count N] [--quiet]
+int main(int argc, char** argv) {
+    if (argc < 2) { std::cerr << "usage: md_tail <shm name> [--from-now] [--count N] [--quiet]\n"; return 1; }
+    std::string name = argv[1]; bool from_now = false, quiet = false; long limit = -1;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--from-now") from_now = true;
+        else if (a == "--quiet") quiet = true;
+        else if (a == "--count" && i + 1 < argc) limit = std::atol(argv[++i]);
+        else { std::cerr << "unknown option " << a << "\n"; return 1; }
+    }
+
+    MarketDataReader reader;
+    while (!reader.attach(name, from_now)) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    static const char* names[] = {"", "DATA", "TRADE", "SENTIMENT", "SCENARIO_METRICS", "METRICS", "PNL"};
+    static const int fields[] = {0, 2, 3, 10, 4, 2, 5};
+    MarketRecord r; long seen = 0; int idle = 0;
+    while (limit < 0 || seen < limit) {
+        if (!reader.poll(r)) {
+            // Drained and the writer has unlinked the ring: the engine exited
+            if (++idle % 1000 == 0) { int fd = shm_open(name.c_str(), O_RDONLY, 0); if (fd < 0) break; ::close(fd); }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        idle = 0; ++seen;
+        if (quiet) continue;
+        uint32_t t = (uint32_t)r.type; if (t == 0 || t > 6) continue;
+        if (r.symbol >= 0) std::cout << "S" << r.symbol << " ";
+        std::cout << names[t];
+        if (r.type == RecordType::TRADE) std::cout << " " << r.tag << " " << (r.v[0] ? "BUY" : "SELL") << " " << r.v[1] << " " << r.v[2];
+        else for (int i = 0; i < fields[t]; ++i) std::cout << " " << r.v[i];
+        std::cout << "\n";
+    }
+    std::cerr << "md_tail: " << seen << " records, " << reader.lost() << " lost to overruns\n";
+    return 0;
+}
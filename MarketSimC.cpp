@@ -0,0 +1,144 @@
+#include "marketsim.h"
+#include "MarketSimulation.hpp"
+#include <new>
+#include <string>
+#include <vector>
+#include <exception>
+
+// C API over MarketSimulation (marketsim.h). No exception crosses the boundary: every
+// entry point maps failures to a status code and a per-thread message.
+
+static thread_local std::string last_error;
+static int fail(int status, const char* what) { last_error = what; return status; }
+
+// Sink for MarketSimulation::step that forwards to the registered callbacks. A publish's
+// broadcasts are gathered into one ms_market_data, emitted by broadcastMetrics (the last).
+struct CallbackSink {
+    ms_tick_fn on_tick = nullptr; void* tick_ctx = nullptr;
+    ms_market_data_fn on_data = nullptr; void* data_ctx = nullptr;
+    ms_fill_fn on_fill = nullptr; void* fill_ctx = nullptr;
+    const MarketSimulation* sim = nullptr; ms_market_data md{};
+
+    void recordTick(double time, double price, uint64_t volume) { if (on_tick) { ms_tick t{time, price, volume}; on_tick(tick_ctx, &t); } }
+    void broadcastSentiment(long fb, long fs, long mb, long ms, long mkb, long mks, long nb, long ns, long ub, long us) {
+        const long buy[MS_NUM_CLASSES] = {fb, mb, mkb, nb, ub}, sell[MS_NUM_CLASSES] = {fs, ms, mks, ns, us};
+        for (int c = 0; c < MS_NUM_CLASSES; ++c) { md.buy_volume[c] = buy[c]; md.sell_volume[c] = sell[c]; }
+    }
+    void broadcastScenarioMetrics(double hype, double bubble, long short_interest, double panic) { md.hype = hype; md.bubble_ratio = bubble; md.short_interest = short_interest; md.panic = panic; }
+    void broadcastData(double price, uint32_t volume) { md.price = price; md.volume = volume; }
+    void broadcastPnl(const std::array<double, NUM_AGENT_CLASSES>& c, const std::vector<LedgerEntry>&) { for (int i = 0; i < MS_NUM_CLASSES; ++i) md.class_pnl[i] = c[i]; }
+    void broadcastAccount(const AccountSnapshot&) {}
+    void broadcastMetrics(double spread, long liq) {
+        md.spread = spread; md.liquidity = liq; md.time = sim->time; md.true_value = sim->true_value;
+        if (on_data) on_data(data_ctx, &md);
+    }
+    void broadcastFill(const UserFill& f) { if (on_fill) { ms_fill m{f.user, f.order_id, f.is_buy, f.quantity, f.price}; on_fill(fill_ctx, &m); } }
+};
+
+struct ms_snapshot { MarketSimulation sim; std::vector<UserOrder> pending; };
+
+struct ms_sim {
+    MarketSimulation sim; std::vector<UserOrder> pending, batch; CallbackSink out;
+    bool busy = false;    // inside ms_step: callbacks must not step or restore
+    bool destroy = false; // ms_destroy from a callback: deleted when ms_step unwinds
+    ms_sim(const SimConfig& c, SeedSource& rd) : sim(c, rd) { out.sim = &sim; }
+};
+
+extern "C" {
+
+int ms_api_version(void) { return MS_API_VERSION; }
+const char* ms_last_error(void) { return last_error.c_str(); }
+ms_config ms_default_config(void) { return ms_config{200, 200, 175, 350, 0, 0}; }
+
+ms_sim* ms_create(const ms_config* config) {
+    if (!config) { fail(MS_EINVAL, "config is NULL"); return nullptr; }
+    if (config->makers < 0 || config->fundamental < 0 || config->momentum < 0 || config->noise < 0) { fail(MS_EINVAL, "agent counts must be >= 0"); return nullptr; }
+    try {
+        SimConfig c{config->makers, config->fundamental, config->momentum, config->noise};
+        if (config->seeded) { SeedSource rd(config->seed); return new ms_sim(c, rd); }
+        SeedSource rd; return new ms_sim(c, rd);
+    } catch (const std::exception& e) { fail(MS_EINTERNAL, e.what()); return nullptr; }
+}
+
+void ms_destroy(ms_sim* sim) {
+    if (!sim) return;
+    if (sim->busy) sim->destroy = true;
+    else delete sim;
+}
+
+int ms_step(ms_sim* sim, int64_t ticks) {
+    if (!sim || ticks < 0) return fail(MS_EINVAL, "need a handle and ticks >= 0");
+    if (sim->busy) return fail(MS_EBUSY, "ms_step called from a callback");
+    sim->busy = true;
+    int status = MS_OK;
+    try {
+        // Orders queued by callbacks during a tick land in `pending` and enter on the next one
+        for (int64_t i = 0; i < ticks && !sim->destroy; ++i) { sim->batch.swap(sim->pending); sim->sim.step(sim->batch, sim->out); sim->batch.clear(); }
+    } catch (const std::exception& e) { status = fail(MS_EINTERNAL, e.what()); }
+    sim->busy = false;
+    if (sim->destroy) delete sim;
+    return status;
+}
+
+int ms_set_scenario(ms_sim* sim, int scenario) {
+    if (!sim || scenario < MS_NORMAL || scenario > MS_SHORT_SQUEEZE) return fail(MS_EINVAL, "scenario must be MS_NORMAL, MS_PUMP_DUMP or MS_SHORT_SQUEEZE");
+    sim->sim.set_phase(static_cast<MarketScenario>(scenario));
+    return MS_OK;
+}
+
+int ms_submit(ms_sim* sim, uint32_t user, int is_buy, double price, int32_t quantity) {
+    if (!sim || quantity <= 0 || !(price > 0)) return fail(MS_EINVAL, "price and quantity must be positive");
+    try { sim->pending.push_back(UserOrder{is_buy != 0, quantity, price, user}); }
+    catch (const std::bad_alloc&) { return fail(MS_EINTERNAL, "out of memory"); }
+    return MS_OK;
+}
+
+int ms_cancel(ms_sim* sim, uint32_t user, uint64_t order_id) {
+    if (!sim || !order_id) return fail(MS_EINVAL, "need a handle and a non-zero order id");
+    UserOrder u{}; u.user = user; u.cancel_id = order_id;
+    try { sim->pending.push_back(u); }
+    catch (const std::bad_alloc&) { return fail(MS_EINTERNAL, "out of memory"); }
+    return MS_OK;
+}
+
+int ms_on_tick(ms_sim* sim, ms_tick_fn fn, void* ctx) { if (!sim) return fail(MS_EINVAL, "handle is NULL"); sim->out.on_tick = fn; sim->out.tick_ctx = ctx; return MS_OK; }
+int ms_on_market_data(ms_sim* sim, ms_market_data_fn fn, void* ctx) { if (!sim) return fail(MS_EINVAL, "handle is NULL"); sim->out.on_data = fn; sim->out.data_ctx = ctx; return MS_OK; }
+int ms_on_fill(ms_sim* sim, ms_fill_fn fn, void* ctx) { if (!sim) return fail(MS_EINVAL, "handle is NULL"); sim->out.on_fill = fn; sim->out.fill_ctx = ctx; return MS_OK; }
+
+double ms_time(const ms_sim* sim) { return sim ? sim->sim.time : 0.0; }
+double ms_price(const ms_sim* sim) { return sim ? sim->sim.price : 0.0; }
+double ms_true_value(const ms_sim* sim) { return sim ? sim->sim.true_value : 0.0; }
+int64_t ms_ticks(const ms_sim* sim) { return sim ? sim->sim.tick_count : 0; }
+
+int ms_get_account(ms_sim* sim, uint32_t user, ms_account* out, ms_open_order* orders, uint32_t capacity) {
+    if (!sim || !out) return fail(MS_EINVAL, "need a handle and an output account");
+    MarketSimulation& s = sim->sim;
+    *out = ms_account{0, 0.0, 0.0, 0.0, 0};
+    const std::vector<OpenOrder>* open = s.users.open_orders(user);
+    if (!open) return MS_OK;
+    uint32_t a = s.users.ledger_account(user, s.ledger);
+    *out = ms_account{s.ledger.position[a], s.ledger.cash[a], s.ledger.realized[a], s.ledger.unrealized(a, s.price), (uint32_t)open->size()};
+    for (uint32_t i = 0; orders && i < capacity && i < open->size(); ++i) {
+        const OpenOrder& o = (*open)[i];
+        orders[i] = ms_open_order{o.id, o.side == Side::BUY, o.price, o.remaining};
+    }
+    return MS_OK;
+}
+
+ms_snapshot* ms_snapshot_take(const ms_sim* sim) {
+    if (!sim) { fail(MS_EINVAL, "handle is NULL"); return nullptr; }
+    try { return new ms_snapshot{sim->sim, sim->pending}; }
+    catch (const std::exception& e) { fail(MS_EINTERNAL, e.what()); return nullptr; }
+}
+
+int ms_snapshot_restore(ms_sim* sim, const ms_snapshot* snapshot) {
+    if (!sim || !snapshot) return fail(MS_EINVAL, "need a handle and a snapshot");
+    if (sim->busy) return fail(MS_EBUSY, "ms_snapshot_restore called from a callback");
+    try { sim->sim = snapshot->sim; sim->pending = snapshot->pending; }
+    catch (const std::exception& e) { return fail(MS_EINTERNAL, e.what()); }
+    return MS_OK;
+}
+
+void ms_snapshot_free(ms_snapshot* snapshot) { delete snapshot; }
+
+}
@@ -0,0 +1,285 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "MarketSimulation.hpp"
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// In-process Python module for the very volatile market (make python -> marketsim*.so):
+//     import marketsim, numpy as np
+//     sim = marketsim.Simulation(makers=200, fundamental=200, momentum=175, noise=350, seed=42)
+//     sim.step(100000)                      # GIL released while stepping
+//     sim.submit(user=1, is_buy=True, price=101.0, quantity=100)   # enters on the next tick
+//     prices = np.asarray(sim.prices)       # zero-copy view of the engine's per-tick history
+// Histories (times, prices, volumes per tick; spreads, liquidity per publish) export the
+// engine's vectors through the buffer protocol. Like bytearray, a history with live views
+// cannot be reallocated: step() raises BufferError rather than outgrow `capacity` then.
+
+// Sink for MarketSimulation::step that keeps histories instead of broadcasting
+struct HistorySink {
+    std::vector<double> times, prices, spreads; std::vector<uint64_t> volumes; std::vector<int64_t> liquidity;
+    std::vector<UserFill> fills;
+
+    void recordTick(double time, double price, uint64_t volume) { times.push_back(time); prices.push_back(price); volumes.push_back(volume); }
+    void broadcastMetrics(double spread, long liq) { spreads.push_back(spread); liquidity.push_back(liq); }
+    void broadcastFill(const UserFill& f) { fills.push_back(f); }
+    void broadcastData(double, uint32_t) {}
+    void broadcastSentiment(long, long, long, long, long, long, long, long, long, long) {}
+    void broadcastScenarioMetrics(double, double, long, double) {}
+    void broadcastPnl(const std::array<double, NUM_AGENT_CLASSES>&, const std::vector<LedgerEntry>&) {}
+    void broadcastAccount(const AccountSnapshot&) {}
+};
+
+enum Series { TIMES, PRICES, VOLUMES, SPREADS, LIQUIDITY };
+
+typedef struct {
+    PyObject_HEAD
+    MarketSimulation* sim; HistorySink* out; std::vector<UserOrder>* pending;
+    Py_ssize_t capacity, exports; bool busy; // busy: step() running with the GIL released
+} SimulationObject;
+
+typedef struct { PyObject_HEAD SimulationObject* owner; int series; } HistoryObject;
+
+static PyTypeObject SimulationType = {PyVarObject_HEAD_INIT(NULL, 0)};
+static PyTypeObject HistoryType = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+// ---- History: a 1-D buffer over one of the sink's vectors ----
+
+static void series_span(SimulationObject* s, int series, void** data, Py_ssize_t* n, Py_ssize_t* itemsize, const char** format) {
+    HistorySink& o = *s->out;
+    switch (series) {
+        case TIMES: *data = o.times.data(); *n = o.times.size(); *itemsize = sizeof(double); *format = "d"; break;
+        case PRICES: *data = o.prices.data(); *n = o.prices.size(); *itemsize = sizeof(double); *format = "d"; break;
+        case VOLUMES: *data = o.volumes.data(); *n = o.volumes.size(); *itemsize = sizeof(uint64_t); *format = "Q"; break;
+        case SPREADS: *data = o.spreads.data(); *n = o.spreads.size(); *itemsize = sizeof(double); *format = "d"; break;
+        default: *data = o.liquidity.data(); *n = o.liquidity.size(); *itemsize = sizeof(int64_t); *format = "q"; break;
+    }
+}
+
+static int History_getbuffer(HistoryObject* self, Py_buffer* view, int flags) {
+    if (flags & PyBUF_WRITABLE) { PyErr_SetString(PyExc_BufferError, "history is read-only"); return -1; }
+    if (self->owner->busy) { PyErr_SetString(PyExc_BufferError, "simulation is stepping in another thread"); return -1; }
+    void* data; Py_ssize_t n, itemsize; const char* format;
+    series_span(self->owner, self->series, &data, &n, &itemsize, &format);
+    Py_ssize_t* dims = (Py_ssize_t*)PyMem_Malloc(2 * sizeof(Py_ssize_t)); // shape, stride
+    if (!dims) { PyErr_NoMemory(); return -1; }
+    dims[0] = n; dims[1] = itemsize;
+    view->buf = data; view->obj = (PyObject*)self; Py_INCREF(self);
+    view->len = n * itemsize; view->itemsize = itemsize; view->readonly = 1; view->ndim = 1;
+    view->format = (flags & PyBUF_FORMAT) ? (char*)format : NULL;
+    view->shape = (flags & PyBUF_ND) ? &dims[0] : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &dims[1] : NULL;
+    view->suboffsets = NULL; view->internal = dims;
+    self->owner->exports++;
+    return 0;
+}
+
+static void History_releasebuffer(HistoryObject* self, Py_buffer* view) { PyMem_Free(view->internal); self->owner->exports--; }
+
+static Py_ssize_t History_len(HistoryObject* self) {
+    if (self->owner->busy) { PyErr_SetString(PyExc_BufferError, "simulation is stepping in another thread"); return -1; }
+    void* data; Py_ssize_t n, itemsize; const char* format;
+    series_span(self->owner, self->series, &data, &n, &itemsize, &format);
+    return n;
+}
+
+static void History_dealloc(HistoryObject* self) { Py_XDECREF(self->owner); Py_TYPE(self)->tp_free((PyObject*)self); }
+
+static PyBufferProcs History_as_buffer = {(getbufferproc)History_getbuffer, (releasebufferproc)History_releasebuffer};
+static PySequenceMethods History_as_sequence = {(lenfunc)History_len};
+
+// ---- Simulation ----
+
+static PyObject* Simulation_new(PyTypeObject* type, PyObject*, PyObject*) {
+    SimulationObject* self = (SimulationObject*)type->tp_alloc(type, 0);
+    if (self) { self->sim = nullptr; self->out = nullptr; self->pending = nullptr; self->capacity = 0; self->exports = 0; self->busy = false; }
+    return (PyObject*)self;
+}
+
+static int Simulation_init(SimulationObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"makers", "fundamental", "momentum", "noise", "seed", "scenario", "capacity", NULL};
+    SimConfig config{200, 200, 175, 350}; PyObject* seed = Py_None; PyObject* scenario_arg = Py_None; Py_ssize_t capacity = 1 << 20;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|iiiiOOn", (char**)kwlist, &config.num_makers, &config.num_fundamental, &config.num_momentum, &config.num_noise, &seed, &scenario_arg, &capacity)) return -1;
+    if (self->sim) { PyErr_SetString(PyExc_RuntimeError, "Simulation already initialized"); return -1; }
+    if (config.num_makers < 0 || config.num_fundamental < 0 || config.num_momentum < 0 || config.num_noise < 0) { PyErr_SetString(PyExc_ValueError, "population sizes must be >= 0"); return -1; }
+    long scenario = -1;
+    if (scenario_arg != Py_None) {
+        scenario = PyLong_AsLong(scenario_arg); if (PyErr_Occurred()) return -1;
+        if (scenario < 0 || scenario > 2) { PyErr_SetString(PyExc_ValueError, "scenario must be 0 (NORMAL), 1 (PUMP_DUMP) or 2 (SHORT_SQUEEZE)"); return -1; }
+    }
+    try {
+        std::unique_ptr<SeedSource> rd;
+        if (seed == Py_None) rd = std::make_unique<SeedSource>();
+        else { unsigned long s = PyLong_AsUnsignedLong(seed); if (PyErr_Occurred()) return -1; rd = std::make_unique<SeedSource>((unsigned int)s); }
+        self->sim = new MarketSimulation(config, *rd);
+        self->out = new HistorySink(); self->pending = new std::vector<UserOrder>();
+        self->capacity = capacity;
+        self->out->times.reserve(capacity); self->out->prices.reserve(capacity); self->out->volumes.reserve(capacity);
+        self->out->spreads.reserve(capacity / publishInterval() + 1); self->out->liquidity.reserve(capacity / publishInterval() + 1);
+        if (scenario >= 0) self->sim->set_phase(static_cast<MarketScenario>(scenario));
+    } catch (const std::exception& e) { PyErr_SetString(PyExc_RuntimeError, e.what()); return -1; }
+    return 0;
+}
+
+static void Simulation_dealloc(SimulationObject* self) {
+    delete self->sim; delete self->out; delete self->pending;
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+#define REQUIRE_SIM(self) \
+    if (!(self)->sim) { PyErr_SetString(PyExc_RuntimeError, "Simulation not initialized"); return NULL; } \
+    if ((self)->busy) { PyErr_SetString(PyExc_RuntimeError, "Simulation is stepping in another thread"); return NULL; }
+
+static PyObject* Simulation_step(SimulationObject* self, PyObject* args) {
+    Py_ssize_t n = 1; if (!PyArg_ParseTuple(args, "|n", &n)) return NULL;
+    REQUIRE_SIM(self);
+    if (n < 0) { PyErr_SetString(PyExc_ValueError, "tick count must be >= 0"); return NULL; }
+    HistorySink& out = *self->out;
+    size_t publishes = n / publishInterval() + 1;
+    if (self->exports > 0 && (out.prices.size() + n > out.prices.capacity() || out.spreads.size() + publishes > out.spreads.capacity())) {
+        PyErr_SetString(PyExc_BufferError, "history views are alive and the step would outgrow capacity; release them or raise capacity");
+        return NULL;
+    }
+    self->busy = true;
+    Py_BEGIN_ALLOW_THREADS
+    std::vector<UserOrder> none;
+    for (Py_ssize_t i = 0; i < n; ++i) self->sim->step(i == 0 ? *self->pending : none, out);
+    if (n > 0) self->pending->clear();
+    Py_END_ALLOW_THREADS
+    self->busy = false;
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_submit(SimulationObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"user", "is_buy", "price", "quantity", NULL};
+    unsigned int user; int is_buy, qty; double price;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Ipdi", (char**)kwlist, &user, &is_buy, &price, &qty)) return NULL;
+    REQUIRE_SIM(self);
+    if (qty <= 0 || price <= 0) { PyErr_SetString(PyExc_ValueError, "price and quantity must be positive"); return NULL; }
+    self->pending->push_back(UserOrder{(bool)is_buy, qty, price, user});
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_cancel(SimulationObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"user", "order_id", NULL};
+    unsigned int user; unsigned long long id;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "IK", (char**)kwlist, &user, &id)) return NULL;
+    REQUIRE_SIM(self);
+    UserOrder u{}; u.user = user; u.cancel_id = id;
+    self->pending->push_back(u);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Simulation_set_scenario(SimulationObject* self, PyObject* args) {
+    int s; if (!PyArg_ParseTuple(args, "i", &s)) return NULL;
+    REQUIRE_SIM(self);
+    if (s < 0 || s > 2) { PyErr_SetString(PyExc_ValueError, "scenario must be 0 (NORMAL), 1 (PUMP_DUMP) or 2 (SHORT_SQUEEZE)"); return NULL; }
+    self->sim->set_phase(static_cast<MarketScenario>(s));
+    Py_RETURN_NONE;
+}
+
+// {position, cash, realized, unrealized, open: [(order_id, is_buy, price, remaining)]}
+static PyObject* Simulation_account(SimulationObject* self, PyObject* args) {
+    unsigned int user; if (!PyArg_ParseTuple(args, "I", &user)) return NULL;
+    REQUIRE_SIM(self);
+    MarketSimulation& sim = *self->sim;
+    const std::vector<OpenOrder>* open = sim.users.open_orders(user);
+    int64_t position = 0; double cash = 0, realized = 0, unrealized = 0;
+    if (open) {
+        uint32_t a = sim.users.ledger_account(user, sim.ledger);
+        position = sim.ledger.position[a]; cash = sim.ledger.cash[a]; realized = sim.ledger.realized[a]; unrealized = sim.ledger.unrealized(a, sim.price);
+    }
+    PyObject* orders = PyList_New(0);
+    if (!orders) return NULL;
+    if (open) for (auto& o : *open) {
+        PyObject* t = Py_BuildValue("(KOdI)", (unsigned long long)o.id, o.side == Side::BUY ? Py_True : Py_False, o.price, o.remaining);
+        if (!t || PyList_Append(orders, t) < 0) { Py_XDECREF(t); Py_DECREF(orders); return NULL; }
+        Py_DECREF(t);
+    }
+    return Py_BuildValue("{s:L,s:d,s:d,s:d,s:N}", "position", (long long)position, "cash", cash, "realized", realized, "unrealized", unrealized, "open", orders);
+}
+
+// User fills since the last call: [(user, order_id, is_buy, quantity, price)]
+static PyObject* Simulation_fills(SimulationObject* self, PyObject*) {
+    REQUIRE_SIM(self);
+    PyObject* list = PyList_New(0);
+    if (!list) return NULL;
+    for (auto& f : self->out->fills) {
+        PyObject* t = Py_BuildValue("(IKOId)", f.user, (unsigned long long)f.order_id, f.is_buy ? Py_True : Py_False, f.quantity, f.price);
+        if (!t || PyList_Append(list, t) < 0) { Py_XDECREF(t); Py_DECREF(list); return NULL; }
+        Py_DECREF(t);
+    }
+    self->out->fills.clear();
+    return list;
+}
+
+static PyObject* Simulation_history(SimulationObject* self, int series) {
+    REQUIRE_SIM(self);
+    HistoryObject* h = PyObject_New(HistoryObject, &HistoryType);
+    if (!h) return NULL;
+    Py_INCREF(self); h->owner = self; h->series = series;
+    return (PyObject*)h;
+}
+static PyObject* Simulation_get_times(SimulationObject* self, void*) { return Simulation_history(self, TIMES); }
+static PyObject* Simulation_get_prices(SimulationObject* self, void*) { return Simulation_history(self, PRICES); }
+static PyObject* Simulation_get_volumes(SimulationObject* self, void*) { return Simulation_history(self, VOLUMES); }
+static PyObject* Simulation_get_spreads(SimulationObject* self, void*) { return Simulation_history(self, SPREADS); }
+static PyObject* Simulation_get_liquidity(SimulationObject* self, void*) { return Simulation_history(self, LIQUIDITY); }
+static PyObject* Simulation_get_time(SimulationObject* self, void*) { REQUIRE_SIM(self); return PyFloat_FromDouble(self->sim->time); }
+static PyObject* Simulation_get_price(SimulationObject* self, void*) { REQUIRE_SIM(self); return PyFloat_FromDouble(self->sim->price); }
+static PyObject* Simulation_get_true_value(SimulationObject* self, void*) { REQUIRE_SIM(self); return PyFloat_FromDouble(self->sim->true_value); }
+static PyObject* Simulation_get_ticks(SimulationObject* self, void*) { REQUIRE_SIM(self); return PyLong_FromSize_t(self->out->prices.size()); }
+static PyObject* Simulation_get_scenario(SimulationObject* self, void*) { REQUIRE_SIM(self); return PyLong_FromLong((long)self->sim->market.scenario); }
+
+static PyMethodDef Simulation_methods[] = {
+    {"step", (PyCFunction)Simulation_step, METH_VARARGS, "step(n=1): run n ticks; queued orders enter on the first"},
+    {"submit", (PyCFunction)(void(*)(void))Simulation_submit, METH_VARARGS | METH_KEYWORDS, "submit(user, is_buy, price, quantity): queue a limit order"},
+    {"cancel", (PyCFunction)(void(*)(void))Simulation_cancel, METH_VARARGS | METH_KEYWORDS, "cancel(user, order_id): queue a cancel"},
+    {"set_scenario", (PyCFunction)Simulation_set_scenario, METH_VARARGS, "set_scenario(s): switch phase (0 normal, 1 pump & dump, 2 short squeeze)"},
+    {"account", (PyCFunction)Simulation_account, METH_VARARGS, "account(user): position, cash, P&L and open orders"},
+    {"fills", (PyCFunction)Simulation_fills, METH_NOARGS, "fills(): user fills since the last call"},
+    {NULL}
+};
+
+static PyGetSetDef Simulation_getset[] = {
+    {"times", (getter)Simulation_get_times, NULL, "simulation time per tick (float64 buffer)", NULL},
+    {"prices", (getter)Simulation_get_prices, NULL, "last traded price per tick (float64 buffer)", NULL},
+    {"volumes", (getter)Simulation_get_volumes, NULL, "traded volume per tick (uint64 buffer)", NULL},
+    {"spreads", (getter)Simulation_get_spreads, NULL, "top-of-book spread per publish (float64 buffer)", NULL},
+    {"liquidity", (getter)Simulation_get_liquidity, NULL, "top-of-book size per publish (int64 buffer)", NULL},
+    {"time", (getter)Simulation_get_time, NULL, "simulation seconds", NULL},
+    {"price", (getter)Simulation_get_price, NULL, "last traded price", NULL},
+    {"true_value", (getter)Simulation_get_true_value, NULL, "fundamental value", NULL},
+    {"ticks", (getter)Simulation_get_ticks, NULL, "ticks run", NULL},
+    {"scenario", (getter)Simulation_get_scenario, NULL, "current phase", NULL},
+    {NULL}
+};
+
+static PyModuleDef marketsim_module = {PyModuleDef_HEAD_INIT, "marketsim", "In-process very volatile market simulation.", -1, NULL};
+
+PyMODINIT_FUNC PyInit_marketsim(void) {
+    HistoryType.tp_name = "marketsim.History";
+    HistoryType.tp_basicsize = sizeof(HistoryObject);
+    HistoryType.tp_dealloc = (destructor)History_dealloc;
+    HistoryType.tp_as_buffer = &History_as_buffer;
+    HistoryType.tp_as_sequence = &History_as_sequence;
+    HistoryType.tp_flags = Py_TPFLAGS_DEFAULT;
+    HistoryType.tp_doc = "Read-only view of a simulation history; use numpy.asarray() or memoryview()";
+
+    SimulationType.tp_name = "marketsim.Simulation";
+    SimulationType.tp_basicsize = sizeof(SimulationObject);
+    SimulationType.tp_new = Simulation_new;
+    SimulationType.tp_init = (initproc)Simulation_init;
+    SimulationType.tp_dealloc = (destructor)Simulation_dealloc;
+    SimulationType.tp_methods = Simulation_methods;
+    SimulationType.tp_getset = Simulation_getset;
+    SimulationType.tp_flags = Py_TPFLAGS_DEFAULT;
+    SimulationType.tp_doc = "Simulation(makers=200, fundamental=200, momentum=175, noise=350, seed=None, scenario=-1, capacity=2**20)";
+
+    if (PyType_Ready(&HistoryType) < 0 || PyType_Ready(&SimulationType) < 0) return NULL;
+    PyObject* m = PyModule_Create(&marketsim_module);
+    if (!m) return NULL;
+    Py_INCREF(&SimulationType);
+    if (PyModule_AddObject(m, "Simulation", (PyObject*)&SimulationType) < 0) { Py_DECREF(&SimulationType); Py_DECREF(m); return NULL; }
+    return m;
+}
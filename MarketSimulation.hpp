@@ -0,0 +1,278 @@
+#ifndef MARKET_SIMULATION_HPP
+#define MARKET_SIMULATION_HPP
+
+#include "EngineInterface.hpp"
+#include "LimitOrderBook.hpp"
+#include "AgentLedger.hpp"
+#include "UserAccounts.hpp"
+#include "ScenarioTimeline.hpp"
+#include "VeryVolatileAgents.hpp"
+#include "NoiseCrowd.hpp"
+#include "EventQueue.hpp"
+#include "OrderLatency.hpp"
+#include "HawkesProcess.hpp"
+#include "PhaseTrace.hpp"
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+// The very volatile market as a steppable object: one step() is one engine tick. Output
+// goes to a sink with the EngineInterface broadcast/record methods, so the same code runs
+// behind ZMQ, headless, or embedded (MarketSimPy.cpp). Optional features still come from
+// the SIM_* environment at construction. All state lives in MarketState, so a copy is a
+// full snapshot (book, agents, RNGs, in-flight orders) that continues bit-for-bit like the
+// original; copying re-points the agents at the copy's own MarketContext.
+struct MarketState {
+    LimitOrderBook book; AgentLedger ledger; UserAccounts users;
+    MarketContext market; ScenarioTimeline timeline; LatencyModel latency;
+    std::vector<MarketMaker> makers; std::vector<NoiseTrader> noise; std::vector<MomentumTrader> momentum; std::vector<FundamentalTrader> fundamental;
+    NoiseCrowd crowd;
+
+    double time = 0.0, price = 100.0, true_value = 100.0, realized_vol = 0.005, last_price = 100.0;
+    uint64_t oid = 1; long short_interest = 0; int tick_count = 0; uint32_t tick_volume = 0, publish_volume = 0; // publish_volume: since the last publish
+    AgentStats s_fund, s_mom, s_make, s_noise, s_user;
+
+protected:
+    MarketState(unsigned int seed) : gen(seed) {}
+
+    std::mt19937 gen; std::normal_distribution<> Z{0.0, 1.0};
+    bool use_crowd = false, des = false;
+    EventQueue wakes;
+    std::optional<HawkesProcess> hawkes; double hawkes_self = 0.5, hawkes_cross = 0.1;
+    AgentStats* class_stats[NUM_AGENT_CLASSES] = {&s_fund, &s_mom, &s_make, &s_noise, &s_user};
+};
+
+class MarketSimulation : public MarketState {
+public:
+    static constexpr double annual_return = 0.28, annual_volatility = 1.50;
+    static constexpr double seconds_per_year = 252 * 6.5 * 60 * 60, dt = 60.0, vol_alpha = 0.01;
+
+    MarketSimulation(const SimConfig& config, SeedSource& rd) : MarketState(rd()) {
+        makers.reserve(config.num_makers); momentum.reserve(config.num_momentum); fundamental.reserve(config.num_fundamental);
+        for (int i=0; i<config.num_makers; ++i) makers.emplace_back(rd());
+        // SIM_NOISE_CROWD=1: noise traders as one batched population (NoiseCrowd.hpp) for crowds of 10^5+
+        use_crowd = std::getenv("SIM_NOISE_CROWD") != nullptr;
+        if (!use_crowd) { noise.reserve(config.num_noise); for (int i=0; i<config.num_noise; ++i) noise.emplace_back(rd()); }
+        for (int i=0; i<config.num_momentum; ++i) momentum.emplace_back(rd(), 100.0);
+        for (int i=0; i<config.num_fundamental; ++i) fundamental.emplace_back(rd());
+        for (auto& a : makers) a.account = ledger.add_account(AgentClass::MAKER);
+        for (auto& a : fundamental) a.account = ledger.add_account(AgentClass::FUNDAMENTAL);
+        for (auto& a : momentum) a.account = ledger.add_account(AgentClass::MOMENTUM);
+        for (auto& a : noise) a.account = ledger.add_account(AgentClass::NOISE);
+        rebind();
+        if (use_crowd) for (int i=0; i<config.num_noise; ++i) crowd.add(ledger.add_account(AgentClass::NOISE), rd());
+
+        // FIX: Initialize peak_price to start price to ensure hype starts at 90% immediately
+        market.peak_price = 100.0;
+
+        // SIM_KERNEL=des: discrete-event agents (EventQueue.hpp); ticks still drive fundamentals,
+        // user orders, publishing and pacing
+        const char* kernel = std::getenv("SIM_KERNEL"); des = kernel && std::string(kernel) == "des";
+        // SIM_HAWKES=<self>[:<cross>[:<decay s>]] with the event kernel: class-level wake-ups from a
+        // Hawkes process over maker/fundamental/noise/momentum (HawkesProcess.hpp), each waking a
+        // random agent of its class. self/cross are branching ratios (default 0.5:0.1:5).
+        if (const char* h = std::getenv("SIM_HAWKES"); h && des && makers.size() + fundamental.size() + noise.size() + momentum.size() > 0) {
+            double decay = 5.0; std::sscanf(h, "%lf:%lf:%lf", &hawkes_self, &hawkes_cross, &decay);
+            if (hawkes_self + 3 * hawkes_cross >= 1.0) std::cerr << "SIM_HAWKES: branching ratio " << hawkes_self + 3 * hawkes_cross << " >= 1, arrivals will explode" << std::endl;
+            hawkes.emplace(4, 1.0 / decay, rd());
+        }
+        if (des && !hawkes) {
+            wakes.reserve(makers.size() + fundamental.size() + noise.size() + momentum.size());
+            for (uint32_t i = 0; i < makers.size(); ++i) wakes.push(makers[i].wake_time(), WAKE_MAKER | i);
+            for (uint32_t i = 0; i < fundamental.size(); ++i) wakes.push(fundamental[i].wake_time(), WAKE_FUND | i);
+            for (uint32_t i = 0; i < noise.size(); ++i) wakes.push(noise[i].wake_time(), WAKE_NOISE | i);
+            for (uint32_t i = 0; i < momentum.size(); ++i) wakes.push(momentum[i].wake_time(), WAKE_MOM | i);
+        }
+        if (latency.any()) latency.seed(rd()); // SIM_LATENCY (OrderLatency.hpp)
+        // SIM_WARM_START=<orders per side>: start from steady-state depth instead of an empty book
+        if (const char* w = std::getenv("SIM_WARM_START")) warm_start(std::atoi(w), rd());
+    }
+    MarketSimulation(const MarketSimulation& o) : MarketState(o) { rebind(); }
+    MarketSimulation& operator=(const MarketSimulation& o) { MarketState::operator=(o); rebind(); return *this; }
+
+    void set_phase(MarketScenario s) { market.set_phase(s); }
+
+    // Synthetic resting depth around the current price, bulk-loaded in one pass. Per side: the
+    // makers' quoting distance plus an exponential tail with a mean of 2% of price, which is
+    // where quotes accumulate once the price has wandered for a few hundred ticks. Orders are
+    // maker-sized and owned round-robin by the makers, so later fills land in their ledger.
+    void warm_start(int per_side, unsigned int seed) {
+        if (per_side <= 0 || makers.empty()) return;
+        std::mt19937 g(seed); std::exponential_distribution<> tail(1.0 / (0.02 * price));
+        std::uniform_real_distribution<> jitter(0.9, 1.1); std::uniform_int_distribution<> size(100, 500);
+        double touch = std::max(0.01, 0.2 * realized_vol * price);
+        std::vector<Order> orders; orders.reserve(2 * (size_t)per_side);
+        for (int i = 0; i < 2 * per_side; ++i) {
+            Side s = i % 2 ? Side::SELL : Side::BUY; double d = touch * jitter(g) + tail(g);
+            orders.push_back(Order{oid++, time, s == Side::BUY ? std::max(0.01, price - d) : price + d, (uint32_t)size(g), s, makers[(i / 2) % makers.size()].account});
+        }
+        book.load(orders);
+    }
+
+    // Bytes and counts per subsystem (MemoryAccounting.hpp). Book heaps count tombstones.
+    MemoryReport memory() const {
+        MemoryReport r;
+        r.add("book.orders", book.index_bytes(), book.live_orders());
+        size_t heap = book.askHeap.size() + book.bidHeap.size();
+        r.add("book.heaps", book.heap_bytes(), heap);
+        r.add("agents.maker", vector_bytes(makers), makers.size());
+        r.add("agents.fundamental", vector_bytes(fundamental), fundamental.size());
+        r.add("agents.momentum", vector_bytes(momentum), momentum.size());
+        r.add("agents.noise", vector_bytes(noise), noise.size());
+        if (use_crowd) r.add("agents.noise_crowd", crowd.memory_bytes(), crowd.size());
+        r.add("ledger", ledger.memory_bytes(), ledger.size());
+        r.add("users", users.memory_bytes(), users.count());
+        if (latency.any()) r.add("latency.in_flight", latency.in_flight.memory_bytes(), latency.in_flight.size());
+        if (des && !hawkes) r.add("events", wakes.memory_bytes(), wakes.size());
+        return r;
+    }
+
+    // One tick: user orders, fundamentals, agents, then the throttled broadcast to `out`
+    template <typename Sink>
+    void step(const std::vector<UserOrder>& user_orders, Sink& out) {
+        SIM_TRACE("tick");
+        tick_volume = 0;
+
+        // 1. Process User
+        {
+            SIM_TRACE("user_orders");
+            for(auto& u : user_orders) {
+                if (u.cancel_id) { users.cancel(u.user, u.cancel_id, book); continue; }
+                submit(Order{oid++, time, u.price, (uint32_t)u.quantity, u.is_buy ? Side::BUY : Side::SELL, users.ledger_account(u.user, ledger)}, AgentClass::USER);
+            }
+        }
+
+        // 2. Fast Sim
+        double mid;
+        {
+            SIM_TRACE("fundamentals");
+            time += dt;
+            double dt_year = dt / seconds_per_year;
+            double drift = (annual_return - 0.5 * std::pow(annual_volatility, 2)) * dt_year;
+            double shock = annual_volatility * std::sqrt(dt_year) * Z(gen);
+            true_value *= std::exp(drift + shock);
+            mid = book.get_mid(price);
+            timeline.advance(time, market);
+            market.peak_price = std::max(market.peak_price, mid);
+        }
+
+        // One agent pass per scenario: the decision kernels are template instances, so the
+        // per-agent loops carry no scenario branches. The pass is picked once per tick.
+        switch (market.scenario) {
+            case MarketScenario::PUMP_DUMP: run_pass<MarketScenario::PUMP_DUMP>(mid); break;
+            case MarketScenario::SHORT_SQUEEZE: run_pass<MarketScenario::SHORT_SQUEEZE>(mid); break;
+            default: run_pass<MarketScenario::NORMAL>(mid); break;
+        }
+
+        if (price > 0) { double ret = std::log(price / last_price); realized_vol = (1 - vol_alpha) * realized_vol + vol_alpha * std::abs(ret); }
+        last_price = price;
+        publish_volume += tick_volume;
+
+        // 3. Throttled Broadcast (5Hz)
+        if (++tick_count % publishInterval() == 0) {
+            { SIM_TRACE("decay"); book.decay(0.05, gen); }
+            SIM_TRACE("publish");
+            { SIM_TRACE("broadcastSentiment"); out.broadcastSentiment(s_fund.buy_vol, s_fund.sell_vol, s_mom.buy_vol, s_mom.sell_vol, s_make.buy_vol, s_make.sell_vol, s_noise.buy_vol, s_noise.sell_vol, s_user.buy_vol, s_user.sell_vol); }
+
+            // Dynamic Hype Metric Calculation
+            double drawdown = (market.peak_price > 0) ? (market.peak_price - price) / market.peak_price : 0.0;
+            // 90% Start (0.9 base), reduces as drawdown increases
+            double hype_val = (market.scenario == MarketScenario::PUMP_DUMP) ? std::max(0.0, (market.params.noise_hype - (drawdown * 8.0)) * 100.0) : 0.0;
+
+            double bubble_ratio = (price > true_value) ? ((price - true_value) / true_value) * 100.0 : 0.0;
+            double panic_meter = (market.scenario == MarketScenario::SHORT_SQUEEZE) ? std::min(100.0, bubble_ratio * 3.0) : 0.0;
+
+            { SIM_TRACE("broadcastScenarioMetrics"); out.broadcastScenarioMetrics(hype_val, bubble_ratio, short_interest, panic_meter); }
+            { SIM_TRACE("broadcastData"); out.broadcastData(price, publish_volume); }
+            { SIM_TRACE("broadcastPnl"); out.broadcastPnl(ledger.class_pnl(price), ledger.leaderboard(5, price)); }
+            { SIM_TRACE("broadcastAccount"); users.sweep(book); users.publish(ledger, price, [&](const AccountSnapshot& a) { out.broadcastAccount(a); }); }
+
+            { SIM_TRACE("broadcastMetrics"); auto [spread, liq] = book.get_metrics(); out.broadcastMetrics(spread, liq); }
+
+            s_fund.reset(); s_mom.reset(); s_make.reset(); s_noise.reset(); s_user.reset(); publish_volume = 0;
+        }
+        { SIM_TRACE("broadcastFill"); users.drain_fills([&](const UserFill& f) { out.broadcastFill(f); }); }
+        { SIM_TRACE("recordTick"); out.recordTick(time, price, tick_volume); }
+    }
+
+private:
+    void rebind() {
+        for (auto& a : makers) a.market = &market;
+        for (auto& a : fundamental) a.market = &market;
+        for (auto& a : momentum) a.market = &market;
+        for (auto& a : noise) a.market = &market;
+        AgentStats* s[NUM_AGENT_CLASSES] = {&s_fund, &s_mom, &s_make, &s_noise, &s_user};
+        std::copy(s, s + NUM_AGENT_CLASSES, class_stats);
+    }
+
+    void deliver(const Order& o, AgentClass c) {
+        auto trades = book.add_order(o);
+        for (auto& t : trades) {
+            tick_volume += t.quantity; price = t.price; class_stats[(int)c]->add(o.side == Side::BUY, t.quantity); ledger.on_fill(t);
+            if (c == AgentClass::FUNDAMENTAL) short_interest += (o.side == Side::SELL) ? (long)t.quantity : -(long)t.quantity;
+        }
+        users.on_trades(o, trades);
+    }
+    // Classes with a SIM_LATENCY entry reach the book only when their delay has elapsed
+    void submit(const Order& o, AgentClass c) {
+        if (latency.delays(c)) latency.in_flight.push(EventQueue::to_ns(o.timestamp + latency.sample(c)), InFlightOrder{o, c});
+        else deliver(o, c);
+    }
+    void arrive(int64_t until_ns) {
+        if (latency.any()) latency.in_flight.advance(until_ns, [&](int64_t t_ns, InFlightOrder& f) { f.order.timestamp = t_ns * 1e-9; deliver(f.order, f.cls); });
+    }
+    void process(Agent& a, std::optional<Order> o, AgentClass c) {
+        if (o) { o->owner = a.account; submit(*o, c); }
+    }
+
+    template <MarketScenario S> void run_pass(double mid) { if (des) event_pass<S>(mid); else agent_pass<S>(mid); }
+
+    template <MarketScenario S> void agent_pass(double mid) {
+        { SIM_TRACE("makers"); for (auto& a : makers) process(a, a.act(mid, realized_vol, time, oid), AgentClass::MAKER); }
+        { SIM_TRACE("fundamental"); for (auto& a : fundamental) process(a, a.act_with_market<S>(true_value, mid, time, oid), AgentClass::FUNDAMENTAL); }
+        { SIM_TRACE("noise"); for (auto& a : noise) process(a, a.decide<S>(mid, realized_vol, time, oid), AgentClass::NOISE); }
+        if (use_crowd) { SIM_TRACE("noise_crowd"); for (const Order& o : crowd.step<S>(time, mid, realized_vol, market, oid)) submit(o, AgentClass::NOISE); }
+        { SIM_TRACE("momentum"); for (auto& a : momentum) process(a, a.act(mid, realized_vol, time, oid), AgentClass::MOMENTUM); }
+        if (latency.any()) { SIM_TRACE("arrivals"); arrive(EventQueue::to_ns(time + dt) - 1); } // everything landing before the next tick
+    }
+
+    // Discrete-event pass: agents due by the end of this tick act one at a time in wake
+    // order, at their own wake time and against the book as it stands.
+    template <MarketScenario S> void event_pass(double mid) {
+        SIM_TRACE("events");
+        for (auto& a : momentum) a.observe(mid);
+        if (use_crowd) for (const Order& o : crowd.step<S>(time, mid, realized_vol, market, oid)) submit(o, AgentClass::NOISE);
+        int64_t end = EventQueue::to_ns(time);
+        if (hawkes) {
+            // Long-run class rates follow the agents' own wake rates under the current params
+            const size_t sizes[4] = {makers.size(), fundamental.size(), noise.size(), momentum.size()};
+            hawkes->calibrate({sizes[0] / 1.5, sizes[1] / market.params.fund_wake_mean, sizes[2] * market.params.noise_wake_speed / 15.0, sizes[3] / (3.0 * market.params.momentum_speed_mult)}, hawkes_self, hawkes_cross);
+            // With zero total intensity the next event is at infinity and pop() returns no class
+            for (double next = hawkes->peek_time(); std::isfinite(next) && EventQueue::to_ns(next) <= end; next = hawkes->peek_time()) {
+                double t; int c = hawkes->pop(t);
+                if (c < 0) break;
+                if (sizes[c]) wake<S>((uint32_t)c << 30, std::uniform_int_distribution<uint32_t>(0, (uint32_t)sizes[c] - 1)(gen), EventQueue::to_ns(t));
+            }
+        }
+        else while (wakes.due(end)) { WakeEvent e = wakes.pop(); wakes.push(wake<S>(e.who & ~WAKE_INDEX, e.who & WAKE_INDEX, e.t_ns), e.who); }
+        arrive(end);
+    }
+
+    // Wakes agent i of a class at t_ns (its own schedule or a Hawkes event); returns its next wake time
+    template <MarketScenario S> double wake(uint32_t cls, uint32_t i, int64_t t_ns) {
+        arrive(t_ns);
+        double t = t_ns * 1e-9, now_mid = book.get_mid(price);
+        switch (cls) {
+            case WAKE_MAKER: { auto& a = makers[i]; a.wake_at(t); process(a, a.act(now_mid, realized_vol, t, oid), AgentClass::MAKER); return a.wake_time(); }
+            case WAKE_FUND: { auto& a = fundamental[i]; a.wake_at(t); process(a, a.act_with_market<S>(true_value, now_mid, t, oid), AgentClass::FUNDAMENTAL); return a.wake_time(); }
+            case WAKE_NOISE: { auto& a = noise[i]; a.wake_at(t); process(a, a.decide<S>(now_mid, realized_vol, t, oid), AgentClass::NOISE); return a.wake_time(); }
+            default: { auto& a = momentum[i]; a.wake_at(t); process(a, a.decide(now_mid, realized_vol, t, oid), AgentClass::MOMENTUM); return a.wake_time(); }
+        }
+    }
+};
+#endif
@@ -0,0 +1,74 @@
+#ifndef MEMORY_ACCOUNTING_HPP
+#define MEMORY_ACCOUNTING_HPP
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// Explicit memory accounting. Subsystems report the bytes their containers hold: vector
+// capacity (not size), and for hash maps the bucket array plus one node per element,
+// estimated as next pointer + value in a 16-byte-aligned malloc chunk (libstdc++, glibc).
+// Reports carry process RSS, peak RSS and malloc's bytes in use next to the accounted
+// total, so the unaccounted rest (transient buffers, allocator slack) stays visible.
+
+template <typename T> size_t vector_bytes(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+template <typename M> size_t hash_bytes(const M& m) {
+    size_t node = (sizeof(void*) + sizeof(typename M::value_type) + sizeof(size_t) + 15) / 16 * 16;
+    return m.bucket_count() * sizeof(void*) + m.size() * node;
+}
+
+// Ticks between MEMORY reports on the diagnostics stream; SIM_MEMORY=<ticks>, 0 = off
+inline int memoryInterval() {
+    static const int n = [] { const char* s = std::getenv("SIM_MEMORY"); return s ? std::max(0, std::atoi(s)) : 0; }();
+    return n;
+}
+
+struct ProcessMemory {
+    size_t rss = 0, peak_rss = 0, heap = 0;
+
+    // Linux: VmRSS/VmHWM from /proc; glibc: bytes handed out by malloc (arenas + mmapped chunks)
+    static ProcessMemory read() {
+        ProcessMemory m;
+        std::ifstream in("/proc/self/status"); std::string key; size_t kb;
+        while (in >> key) {
+            if (key == "VmRSS:" && in >> kb) m.rss = kb * 1024;
+            else if (key == "VmHWM:" && in >> kb) m.peak_rss = kb * 1024;
+        }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 mi = mallinfo2(); m.heap = mi.uordblks + mi.hblkhd;
+#endif
+        return m;
+    }
+};
+
+class MemoryReport {
+public:
+    struct Item { const char* name; size_t bytes, count; };
+    std::vector<Item> items; ProcessMemory process = ProcessMemory::read();
+
+    void add(const char* name, size_t bytes, size_t count) { items.push_back({name, bytes, count}); }
+    size_t total() const { size_t t = 0; for (auto& i : items) t += i.bytes; return t; }
+
+    // MEMORY <tick> <rss> <peak rss> <heap in use> <accounted> <n> then n x (<subsystem> <bytes> <count>)
+    std::string line(long tick) const {
+        std::ostringstream ss;
+        ss << "MEMORY " << tick << " " << process.rss << " " << process.peak_rss << " " << process.heap << " " << total() << " " << items.size();
+        for (auto& i : items) ss << " " << i.name << " " << i.bytes << " " << i.count;
+        return ss.str();
+    }
+
+    void print(FILE* out = stderr) const {
+        std::fprintf(out, "%-22s %14s %12s %10s\n", "subsystem", "bytes", "count", "bytes/item");
+        for (auto& i : items) std::fprintf(out, "%-22s %14zu %12zu %10.0f\n", i.name, i.bytes, i.count, i.count ? (double)i.bytes / i.count : 0.0);
+        std::fprintf(out, "%-22s %14zu\n%-22s %14zu\n%-22s %14zu\n%-22s %14zu\n", "accounted", total(), "malloc in use", process.heap, "RSS", process.rss, "peak RSS", process.peak_rss);
+    }
+};
+#endif
@@ -0,0 +1,120 @@
+#ifndef NOISE_CROWD_HPP
+#define NOISE_CROWD_HPP
+
+#include "EngineInterface.hpp"
+#include "LimitOrderBook.hpp"
+#include "ScenarioTimeline.hpp"
+#include "SimdDispatch.hpp"
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// Noise trader population as parallel arrays, stepped as one batch per tick: a wake scan
+// compacts the indices due this tick (the only SIMD loop, AVX2 clone via SimdDispatch.hpp),
+// then the draws and the order math run as scalar straight-line loops over that batch. The
+// draws gather per-trader states and the Box-Muller step calls libm, so neither vectorizes.
+// Decision rules match NoiseTrader, but each trader carries an 8-byte splitmix64 state
+// instead of an mt19937, so seeded runs differ from the per-object population. A trader
+// costs 24 bytes (wake time, state, account, due slot) plus 56 bytes of per-batch scratch
+// while it is due; scratch grows to the largest batch, which with a 60 s tick against a
+// 15 s mean wake is usually the whole crowd.
+class NoiseCrowd {
+private:
+    std::vector<double> next_wake; std::vector<uint64_t> state; std::vector<uint32_t> account;
+    std::vector<uint32_t> due;                                        // indices woken this tick
+    std::vector<double> u_wake, u_side, u_mix, u_r, u_theta, z_size, z_impact;
+    std::vector<Order> orders;
+
+    static uint64_t next(uint64_t& s) {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull; z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    static double uniform(uint64_t& s) { return ((next(s) >> 11) + 0.5) * 0x1.0p-53; } // open (0, 1)
+
+    // Branch-free compaction of the due indices; blocks with nobody due are skipped whole.
+    SIM_TARGET_CLONES static size_t scan(const double* __restrict wake, size_t n, double time, uint32_t* __restrict out) {
+        size_t m = 0, i = 0;
+        for (; i + 8 <= n; i += 8) {
+            int any = 0; for (int j = 0; j < 8; ++j) any |= wake[i + j] <= time;
+            if (!any) continue;
+            for (int j = 0; j < 8; ++j) { out[m] = (uint32_t)(i + j); m += wake[i + j] <= time; }
+        }
+        for (; i < n; ++i) { out[m] = (uint32_t)i; m += wake[i] <= time; }
+        return m;
+    }
+
+    static void draw(const uint32_t* __restrict due, size_t m, uint64_t* __restrict state, double* __restrict u_wake, double* __restrict u_side, double* __restrict u_mix, double* __restrict u_r, double* __restrict u_theta) {
+        for (size_t k = 0; k < m; ++k) {
+            uint64_t s = state[due[k]];
+            u_wake[k] = uniform(s); u_side[k] = uniform(s); u_mix[k] = uniform(s); u_r[k] = uniform(s); u_theta[k] = uniform(s);
+            state[due[k]] = s;
+        }
+    }
+
+    // Box-Muller: one pair of uniforms gives the size and the impact normal
+    static void normals(size_t m, const double* __restrict u_r, const double* __restrict u_theta, double* __restrict z_size, double* __restrict z_impact) {
+        const double two_pi = 6.283185307179586;
+        for (size_t k = 0; k < m; ++k) {
+            double r = std::sqrt(-2.0 * std::log(u_r[k])), a = two_pi * u_theta[k];
+            z_size[k] = r * std::cos(a); z_impact[k] = r * std::sin(a);
+        }
+    }
+
+public:
+    void add(uint32_t ledger_account, uint64_t seed) {
+        next_wake.push_back(0.0); state.push_back(seed * 0x9E3779B97F4A7C15ull + 1); account.push_back(ledger_account);
+        due.push_back(0);
+    }
+    size_t size() const { return account.size(); }
+    size_t memory_bytes() const {
+        return vector_bytes(next_wake) + vector_bytes(state) + vector_bytes(account) + vector_bytes(due) + vector_bytes(u_wake) + vector_bytes(u_side)
+            + vector_bytes(u_mix) + vector_bytes(u_r) + vector_bytes(u_theta) + vector_bytes(z_size) + vector_bytes(z_impact) + vector_bytes(orders);
+    }
+
+    // Everyone due at `time` decides against the same mid; returns the batch's orders, ids
+    // assigned consecutively from `id`.
+    template <MarketScenario S>
+    const std::vector<Order>& step(double time, double mid, double vol, const MarketContext& market, uint64_t& id) {
+        size_t m = scan(next_wake.data(), next_wake.size(), time, due.data());
+        if (u_wake.size() < m) for (auto* v : {&u_wake, &u_side, &u_mix, &u_r, &u_theta, &z_size, &z_impact}) v->resize(m);
+        draw(due.data(), m, state.data(), u_wake.data(), u_side.data(), u_mix.data(), u_r.data(), u_theta.data());
+        normals(m, u_r.data(), u_theta.data(), z_size.data(), z_impact.data());
+
+        double wake_mean = 15.0 / market.params.noise_wake_speed;
+        for (size_t k = 0; k < m; ++k) next_wake[due[k]] = time - std::log(u_wake[k]) * wake_mean;
+
+        orders.resize(m);
+        if constexpr (S == MarketScenario::PUMP_DUMP) {
+            double drawdown = (market.peak_price > 0) ? (market.peak_price - mid) / market.peak_price : 0.0;
+            double buy_prob = market.params.noise_hype - (drawdown * 8.0);
+            if (buy_prob < 0.05) {
+                // FULL PANIC
+                for (size_t k = 0; k < m; ++k) {
+                    uint32_t qty = std::min(2000u, std::max(100u, (uint32_t)std::exp(4.0 + 0.5 * z_size[k]) * 8));
+                    orders[k] = Order{id + k, time, mid * 0.85, qty, Side::SELL, account[due[k]]};
+                }
+            } else {
+                for (size_t k = 0; k < m; ++k) {
+                    bool buy = u_side[k] < buy_prob;
+                    double size_mult = u_mix[k] < 0.2 ? 3.0 : 1.5;
+                    uint32_t qty = std::min(500u, std::max(1u, (uint32_t)(std::exp(4.0 + 0.5 * z_size[k]) * size_mult)));
+                    orders[k] = Order{id + k, time, buy ? mid * 1.05 : mid * 0.95, qty, buy ? Side::BUY : Side::SELL, account[due[k]]};
+                }
+            }
+        } else {
+            double sell_prob = market.params.noise_sell_prob, scale = (0.05 + 0.5 * vol) * mid;
+            for (size_t k = 0; k < m; ++k) {
+                bool buy = u_side[k] > sell_prob;
+                double impact = std::abs(z_impact[k]) * scale;
+                double p = std::max(0.01, buy ? mid + impact : mid - impact);
+                uint32_t qty = std::min(200u, std::max(1u, (uint32_t)std::exp(4.0 + 0.5 * z_size[k])));
+                orders[k] = Order{id + k, time, p, qty, buy ? Side::BUY : Side::SELL, account[due[k]]};
+            }
+        }
+        id += m;
+        return orders;
+    }
+};
+#endif
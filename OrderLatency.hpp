@@ -0,0 +1,52 @@
+#ifndef ORDER_LATENCY_HPP
+#define ORDER_LATENCY_HPP
+
+#include "AgentLedger.hpp"
+#include "TimingWheel.hpp"
+#include <array>
+#include <random>
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+// Order arrival latency per agent class, from SIM_LATENCY as comma-separated
+// <class>:<base ms>[:<jitter ms>] with class maker|fund|momentum|noise|user, e.g.
+//     SIM_LATENCY=maker:0.2:0.1,noise:40:20,user:15:5
+// Each order is delayed by the base plus exponential jitter with the given mean; unlisted
+// classes reach the book instantly. In-flight orders wait in a TimingWheel (1 ms buckets).
+struct InFlightOrder { Order order; AgentClass cls; };
+
+class LatencyModel {
+private:
+    std::array<double, NUM_AGENT_CLASSES> base{}, jitter{};
+    std::array<bool, NUM_AGENT_CLASSES> delayed{};
+    std::mt19937_64 gen;
+
+public:
+    TimingWheel<InFlightOrder> in_flight;
+
+    LatencyModel() {
+        const char* spec = std::getenv("SIM_LATENCY"); if (!spec) return;
+        static const char* names[NUM_AGENT_CLASSES] = {"fund", "momentum", "maker", "noise", "user"};
+        std::stringstream ss(spec); std::string item;
+        while (std::getline(ss, item, ',')) {
+            std::stringstream is(item); std::string name, b, j;
+            std::getline(is, name, ':'); std::getline(is, b, ':'); std::getline(is, j, ':');
+            int c = 0; while (c < NUM_AGENT_CLASSES && name != names[c]) ++c;
+            if (c == NUM_AGENT_CLASSES || b.empty()) { std::fprintf(stderr, "SIM_LATENCY: cannot parse '%s'\n", item.c_str()); continue; }
+            base[c] = std::atof(b.c_str()) * 1e-3; jitter[c] = j.empty() ? 0.0 : std::atof(j.c_str()) * 1e-3; delayed[c] = true;
+        }
+    }
+    bool any() const { for (bool d : delayed) if (d) return true; return false; }
+    bool delays(AgentClass c) const { return delayed[(int)c]; }
+    void seed(uint64_t s) { gen.seed(s); }
+
+    // Seconds from send to arrival at the book
+    double sample(AgentClass c) {
+        int i = (int)c; double d = base[i];
+        if (jitter[i] > 0) d += std::exponential_distribution<>(1.0 / jitter[i])(gen);
+        return d;
+    }
+};
+#endif
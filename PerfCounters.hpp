@@ -0,0 +1,138 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <utility>
+#include <atomic>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters per engine phase: SIM_PERF=1 opens cycles, instructions, LLC misses and
+// branch misses for the engine thread (perf_event_open, user space only, one group so the
+// four are read together and scaled if the PMU multiplexes). Every SIM_TRACE scope then
+// accumulates its counter deltas, inclusive of nested scopes. tick_report() formats the
+// tick's deltas for the diagnostics stream as
+//     PERF <tick> <n> then n x (<phase> <cycles> <instructions> <llc misses> <branch misses>)
+// and report() prints run totals. A counter the kernel refuses (no PMU, VM, container,
+// perf_event_paranoid) reads -1; with none available SIM_PERF turns itself off with a note.
+// Each read is a syscall (about 1 us), so instrument phases, not per-order code.
+class PhaseCounters {
+public:
+    static constexpr int N = 4;
+    // Atomic: the first thread to open counters may switch it off while others read it in TraceScope
+    static inline std::atomic<bool> enabled{std::getenv("SIM_PERF") != nullptr};
+
+    // Counters are per thread: each thread measures itself
+    static PhaseCounters& local() { thread_local PhaseCounters c; return c; }
+
+    void begin(const char* name) { stack.push_back({name, {}}); read(stack.back().start); }
+    void end() {
+        if (stack.empty()) return;
+        int64_t now[N]; read(now);
+        Frame f = stack.back(); stack.pop_back();
+        Phase& p = phase(f.name);
+        for (int i = 0; i < N; ++i) if (now[i] >= 0) { int64_t d = now[i] - f.start[i]; p.tick[i] += d; p.total[i] += d; }
+        ++p.calls;
+    }
+
+    std::string tick_report() {
+        std::ostringstream ss; int n = 0;
+        for (auto& p : phases) if (p.tick_calls()) ++n;
+        ss << "PERF " << ++ticks << " " << n;
+        for (auto& p : phases) {
+            if (!p.tick_calls()) continue;
+            ss << " " << p.name;
+            for (int i = 0; i < N; ++i) ss << " " << (available[i] ? p.tick[i] : -1);
+            p.reset_tick();
+        }
+        return ss.str();
+    }
+
+    void report(FILE* out = stderr) const {
+        if (phases.empty()) return;
+        std::fprintf(out, "SIM_PERF totals over %llu ticks (-1: counter unavailable)\n%-26s %14s %14s %6s %12s %8s %12s\n",
+            (unsigned long long)ticks, "phase", "cycles", "instructions", "IPC", "LLC misses", "/k instr", "br misses");
+        for (auto& p : phases) {
+            double ipc = p.total[0] > 0 && available[1] ? (double)p.total[1] / p.total[0] : -1;
+            double mpki = p.total[1] > 0 && available[2] ? 1000.0 * p.total[2] / p.total[1] : -1;
+            std::fprintf(out, "%-26s %14lld %14lld %6.2f %12lld %8.2f %12lld\n", p.name,
+                (long long)(available[0] ? p.total[0] : -1), (long long)(available[1] ? p.total[1] : -1), ipc,
+                (long long)(available[2] ? p.total[2] : -1), mpki, (long long)(available[3] ? p.total[3] : -1));
+        }
+    }
+
+    ~PhaseCounters() {
+        report();
+#ifdef __linux__
+        for (int fd : fds) if (fd >= 0) close(fd);
+#endif
+    }
+
+private:
+    struct Frame { const char* name; int64_t start[N]; };
+    struct Phase {
+        const char* name; int64_t tick[N] = {}, total[N] = {}; uint64_t calls = 0, calls_at_tick = 0;
+        bool tick_calls() const { return calls != calls_at_tick; }
+        void reset_tick() { for (auto& t : tick) t = 0; calls_at_tick = calls; }
+    };
+    int fds[N] = {-1, -1, -1, -1}; int leader = -1; bool available[N] = {};
+    std::vector<Frame> stack; std::vector<Phase> phases; uint64_t ticks = 0;
+
+    // Phases are keyed by the scope's string literal
+    Phase& phase(const char* name) {
+        for (auto& p : phases) if (p.name == name) return p;
+        phases.push_back(Phase{name}); return phases.back();
+    }
+
+    PhaseCounters() {
+#ifdef __linux__
+        const std::pair<uint32_t, uint64_t> events[N] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES}, {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}, {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+        int err = 0;
+        for (int i = 0; i < N; ++i) {
+            perf_event_attr a; std::memset(&a, 0, sizeof(a));
+            a.size = sizeof(a); a.type = events[i].first; a.config = events[i].second;
+            a.disabled = leader < 0; a.exclude_kernel = 1; a.exclude_hv = 1;
+            a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = (int)syscall(SYS_perf_event_open, &a, 0, -1, leader, 0);
+            if (fds[i] < 0) { err = errno; continue; }
+            if (leader < 0) leader = fds[i];
+            available[i] = true;
+        }
+        if (leader >= 0) { ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP); ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP); }
+        else {
+            std::fprintf(stderr, "SIM_PERF: hardware counters unavailable (%s; see /proc/sys/kernel/perf_event_paranoid), continuing without them\n", std::strerror(err));
+            enabled = false;
+        }
+#else
+        std::fprintf(stderr, "SIM_PERF: perf_event_open needs Linux, continuing without counters\n");
+        enabled = false;
+#endif
+    }
+
+    // Current counts, scaled for multiplexing; -1 for counters that did not open
+    void read(int64_t* out) {
+        for (int i = 0; i < N; ++i) out[i] = -1;
+#ifdef __linux__
+        if (leader < 0) return;
+        // nr, time_enabled, time_running, then {value, id} per member in open order
+        uint64_t buf[3 + 2 * N];
+        if (::read(leader, buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+        double scale = buf[2] > 0 ? (double)buf[1] / buf[2] : 1.0;
+        for (int i = 0, k = 0; i < N && k < (int)buf[0]; ++i) if (available[i]) out[i] = (int64_t)(buf[3 + 2 * k++] * scale);
+#endif
+    }
+};
+#endif
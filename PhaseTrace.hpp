@@ -0,0 +1,96 @@
+#ifndef PHASE_TRACE_HPP
+#define PHASE_TRACE_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include "PerfCounters.hpp"
+
+// Opt-in timeline of engine phases: SIM_TRACE=<file.json> records begin/end events for every
+// SIM_TRACE("phase") scope and writes them as Chrome trace JSON (chrome://tracing, or
+// ui.perfetto.dev, which opens the same format) when the engine stops. Each thread appends
+// to its own buffer, registered once under a lock, so recording takes no locks and shares no
+// cache lines. SIM_TRACE_MAX caps events per thread (default 2^24); beyond it events are
+// dropped and counted. Disabled, a scope costs one load and branch.
+struct TraceEvent { int64_t t_ns; const char* name; char ph; };
+
+class PhaseTracer {
+private:
+    struct Buffer { std::vector<TraceEvent> events; uint32_t tid; std::string name; size_t dropped = 0; };
+    std::mutex m; std::vector<std::unique_ptr<Buffer>> buffers;
+    std::string path; size_t max_events = size_t(1) << 24; bool dumped = false;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    PhaseTracer() {
+        if (const char* p = std::getenv("SIM_TRACE")) path = p;
+        if (const char* n = std::getenv("SIM_TRACE_MAX")) max_events = std::strtoull(n, nullptr, 10);
+    }
+    Buffer* local() {
+        thread_local Buffer* b = nullptr;
+        if (!b) {
+            std::lock_guard<std::mutex> lock(m);
+            buffers.push_back(std::make_unique<Buffer>()); b = buffers.back().get();
+            b->tid = (uint32_t)buffers.size(); b->events.reserve(size_t(1) << 16);
+        }
+        return b;
+    }
+
+public:
+    static inline const bool enabled = std::getenv("SIM_TRACE") != nullptr;
+
+    static PhaseTracer& instance() { static PhaseTracer t; return t; }
+    ~PhaseTracer() { dump(); }
+
+    void record(const char* name, char ph) {
+        Buffer* b = local();
+        if (b->events.size() >= max_events) { ++b->dropped; return; }
+        b->events.push_back({std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count(), name, ph});
+    }
+    static void name_thread(const char* name) { if (enabled) instance().local()->name = name; }
+
+    // Writes the trace once; call after the traced threads have stopped
+    void dump() {
+        std::lock_guard<std::mutex> lock(m);
+        if (dumped || path.empty()) return;
+        dumped = true;
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) { std::fprintf(stderr, "SIM_TRACE: cannot open %s\n", path.c_str()); return; }
+        std::fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        size_t total = 0, dropped = 0; bool first = true;
+        for (auto& b : buffers) {
+            std::string name = b->name.empty() ? "thread " + std::to_string(b->tid) : b->name;
+            std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", b->tid, name.c_str());
+            first = false;
+            for (auto& e : b->events) std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", e.name, e.ph, e.t_ns * 1e-3, b->tid);
+            total += b->events.size(); dropped += b->dropped;
+        }
+        std::fprintf(f, "\n]}\n"); std::fclose(f);
+        std::fprintf(stderr, "SIM_TRACE: wrote %zu events from %zu threads to %s%s\n", total, buffers.size(), path.c_str(), dropped ? (" (" + std::to_string(dropped) + " dropped, raise SIM_TRACE_MAX)").c_str() : "");
+    }
+};
+
+// Begin/end pair around the enclosing scope, also the phase boundary for SIM_PERF counters
+// (PerfCounters.hpp); `name` must be a string literal
+struct TraceScope {
+    const char* name;
+    explicit TraceScope(const char* n) : name(n) {
+        if (PhaseTracer::enabled) PhaseTracer::instance().record(name, 'B');
+        if (PhaseCounters::enabled) PhaseCounters::local().begin(name);
+    }
+    ~TraceScope() {
+        if (PhaseCounters::enabled) PhaseCounters::local().end();
+        if (PhaseTracer::enabled) PhaseTracer::instance().record(name, 'E');
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define SIM_TRACE_CAT2(a, b) a##b
+#define SIM_TRACE_CAT(a, b) SIM_TRACE_CAT2(a, b)
+#define SIM_TRACE(name) TraceScope SIM_TRACE_CAT(trace_scope_, __LINE__)(name)
+#endif
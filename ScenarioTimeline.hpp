@@ -0,0 +1,121 @@
+#ifndef SCENARIO_TIMELINE_HPP
+#define SCENARIO_TIMELINE_HPP
+
+#include "EngineInterface.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+// Tunable scenario parameters. Each phase starts from its defaults (the values the very
+// volatile engine has always used); timelines can then set or ramp them.
+struct ScenarioParams {
+    double maker_spread_mult = 1.0;   // market maker spread multiplier
+    double fund_wake_mean = 5.0;      // fundamental mean seconds between decisions
+    double fund_fair_mult = 1.0;      // fundamental fair value multiplier
+    double noise_wake_speed = 1.0;    // noise trader wake rate multiplier
+    double noise_hype = 0.9;          // pump: buy probability at zero drawdown
+    double noise_sell_prob = 0.5;     // probability a noise trader sells
+    double momentum_speed_mult = 1.0; // momentum mean reaction time multiplier
+
+    static ScenarioParams defaults(MarketScenario s) {
+        ScenarioParams p;
+        if (s == MarketScenario::PUMP_DUMP) { p.maker_spread_mult = 4.0; p.fund_wake_mean = 0.5; p.noise_wake_speed = 5.0; }
+        if (s == MarketScenario::SHORT_SQUEEZE) { p.fund_fair_mult = 0.95; p.noise_sell_prob = 0.65; }
+        if (s != MarketScenario::NORMAL) p.momentum_speed_mult = 3.0;
+        return p;
+    }
+
+    static double ScenarioParams::* field(const std::string& name) {
+        static const std::pair<const char*, double ScenarioParams::*> table[] = {
+            {"maker_spread_mult", &ScenarioParams::maker_spread_mult}, {"fund_wake_mean", &ScenarioParams::fund_wake_mean},
+            {"fund_fair_mult", &ScenarioParams::fund_fair_mult}, {"noise_wake_speed", &ScenarioParams::noise_wake_speed},
+            {"noise_hype", &ScenarioParams::noise_hype}, {"noise_sell_prob", &ScenarioParams::noise_sell_prob},
+            {"momentum_speed_mult", &ScenarioParams::momentum_speed_mult}};
+        for (auto& [n, f] : table) if (name == n) return f;
+        return nullptr;
+    }
+};
+
+// Scenario state shared by every agent and read once per decision: switching phase is a
+// single assignment, independent of population size.
+struct MarketContext {
+    MarketScenario scenario = MarketScenario::NORMAL;
+    ScenarioParams params;
+    double peak_price = 0.0; // running peak for the pump & dump crash logic
+
+    void set_phase(MarketScenario s) { scenario = s; params = ScenarioParams::defaults(s); if (s != MarketScenario::PUMP_DUMP) peak_price = 0.0; }
+};
+
+// A scenario script compiled into a time-ordered event schedule. File format, one event
+// per line, times in simulation seconds, '#' comments:
+//     <time> phase <NORMAL|PUMP_DUMP|SHORT_SQUEEZE>   switch phase (params reset to its defaults)
+//     <time> set   <param> <value>
+//     <time> ramp  <param> <target> <duration>      linear from the value at <time>
+// advance() consumes due events with a cursor and updates active ramps, so a tick costs
+// O(due events + active ramps).
+class ScenarioTimeline {
+private:
+    enum class Kind { PHASE, SET, RAMP };
+    struct Event { double time; Kind kind; MarketScenario phase; double ScenarioParams::* param; double value, duration; };
+    struct Ramp { double ScenarioParams::* param; double from, to, t0, t1; };
+    std::vector<Event> events; size_t cursor = 0;
+    std::vector<Ramp> ramps;
+
+public:
+    // Loading is opt-in: SIM_TIMELINE=<file>.
+    ScenarioTimeline() { if (const char* path = std::getenv("SIM_TIMELINE")) load(path); }
+
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) { std::fprintf(stderr, "ScenarioTimeline: cannot open %s\n", path.c_str()); return false; }
+        events.clear(); ramps.clear(); cursor = 0;
+        std::string line; int n = 0;
+        while (std::getline(in, line)) {
+            ++n; line = line.substr(0, line.find('#'));
+            std::istringstream ss(line); Event e{}; std::string kind;
+            if (!(ss >> e.time >> kind)) continue;
+            bool ok = false;
+            if (kind == "phase") {
+                std::string p; ss >> p; ok = true;
+                if (p == "NORMAL") e.phase = MarketScenario::NORMAL;
+                else if (p == "PUMP_DUMP") e.phase = MarketScenario::PUMP_DUMP;
+                else if (p == "SHORT_SQUEEZE") e.phase = MarketScenario::SHORT_SQUEEZE;
+                else ok = false;
+                e.kind = Kind::PHASE;
+            } else if (kind == "set" || kind == "ramp") {
+                std::string name; ss >> name >> e.value;
+                e.param = ScenarioParams::field(name);
+                e.kind = kind == "set" ? Kind::SET : Kind::RAMP;
+                ok = e.param && !ss.fail() && (e.kind == Kind::SET || ((ss >> e.duration) && e.duration > 0));
+            }
+            if (ok) events.push_back(e);
+            else std::fprintf(stderr, "ScenarioTimeline: %s:%d: cannot parse '%s'\n", path.c_str(), n, line.c_str());
+        }
+        // Same-time events keep file order, so "phase" then "set" at one time works.
+        std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.time < b.time; });
+        return true;
+    }
+    bool empty() const { return events.empty(); }
+
+    // Applies everything due at `time`; returns true if the phase changed.
+    bool advance(double time, MarketContext& ctx) {
+        bool phase_changed = false;
+        for (; cursor < events.size() && events[cursor].time <= time; ++cursor) {
+            const Event& e = events[cursor];
+            if (e.kind == Kind::PHASE) { ctx.set_phase(e.phase); ramps.clear(); phase_changed = true; }
+            else if (e.kind == Kind::SET) ctx.params.*e.param = e.value;
+            else ramps.push_back({e.param, ctx.params.*e.param, e.value, e.time, e.time + e.duration});
+        }
+        for (size_t i = 0; i < ramps.size();) {
+            Ramp& r = ramps[i]; double f = std::min(1.0, (time - r.t0) / (r.t1 - r.t0));
+            ctx.params.*r.param = r.from + (r.to - r.from) * f;
+            if (f >= 1.0) { ramps[i] = ramps.back(); ramps.pop_back(); } else ++i;
+        }
+        return phase_changed;
+    }
+};
+#endif
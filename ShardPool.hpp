@@ -0,0 +1,78 @@
+#ifndef SHARD_POOL_HPP
+#define SHARD_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <string>
+#include "PhaseTrace.hpp"
+
+// Fixed worker pool with a per-tick barrier. run(job) executes job(w) once on each of
+// size() workers (the caller is worker 0) and returns when all have finished, so the
+// main loop can publish a consistent cross-shard state after every tick.
+// Work is assigned statically: a caller owning N shards runs shard s on worker s % size().
+// Pool threads are named "worker <w>" in SIM_TRACE timelines.
+class ShardPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex m;
+    std::condition_variable cv_start, cv_done;
+    const std::function<void(int)>* job = nullptr;
+    uint64_t generation = 0;
+    int pending = 0;
+    bool stopping = false;
+
+    void worker_loop(int w) {
+        PhaseTracer::name_thread(("worker " + std::to_string(w)).c_str());
+        uint64_t seen = 0;
+        while (true) {
+            const std::function<void(int)>* fn;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv_start.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation; fn = job;
+            }
+            (*fn)(w);
+            std::lock_guard<std::mutex> lock(m);
+            if (--pending == 0) cv_done.notify_one();
+        }
+    }
+
+public:
+    explicit ShardPool(int workers) {
+        if (workers < 1) workers = 1;
+        for (int w = 1; w < workers; ++w) threads.emplace_back(&ShardPool::worker_loop, this, w);
+    }
+    ~ShardPool() {
+        { std::lock_guard<std::mutex> lock(m); stopping = true; }
+        cv_start.notify_all();
+        for (auto& t : threads) t.join();
+    }
+    ShardPool(const ShardPool&) = delete;
+    ShardPool& operator=(const ShardPool&) = delete;
+
+    int size() const { return (int)threads.size() + 1; }
+
+    void run(const std::function<void(int)>& fn) {
+        if (threads.empty()) { fn(0); return; }
+        {
+            std::lock_guard<std::mutex> lock(m);
+            job = &fn; pending = (int)threads.size(); ++generation;
+        }
+        cv_start.notify_all();
+        fn(0);
+        std::unique_lock<std::mutex> lock(m);
+        cv_done.wait(lock, [&] { return pending == 0; });
+    }
+
+    // Convenience: run fn(i) for every shard i in [0, n), sharded statically by worker.
+    void for_each_shard(size_t n, const std::function<void(size_t)>& fn) {
+        int W = size();
+        run([&](int w) { for (size_t i = w; i < n; i += W) fn(i); });
+    }
+};
+#endif
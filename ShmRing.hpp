@@ -0,0 +1,152 @@
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Same-host market data feed over POSIX shared memory. One writer (the engine), any number
+// of readers, fixed-size records in a power-of-two ring. Each slot is a seqlock: the writer
+// makes its sequence odd, copies the record, then publishes an even sequence tied to the
+// record's index, so readers never block the writer and a slow reader detects that its slot
+// was overwritten (an overrun) instead of stalling the engine.
+enum class RecordType : uint32_t { DATA = 1, TRADE = 2, SENTIMENT = 3, SCENARIO_METRICS = 4, METRICS = 5, PNL = 6 };
+
+// Field layout per type mirrors the ZMQ text messages:
+//   DATA: price, volume   TRADE: is_buy, qty, price (agent in tag)   SENTIMENT: 10 volumes
+//   SCENARIO_METRICS: hype, bubble, short_interest, panic   METRICS: spread, liquidity
+//   PNL: 5 class totals (fundamental, momentum, maker, noise, user)
+struct MarketRecord {
+    RecordType type; int32_t symbol; // -1: not tied to one symbol (e.g. aggregate PNL)
+    uint64_t ts_ns;                  // wall-clock publish time, for tick-to-screen latency
+    double v[10];
+    char tag[16];
+};
+
+struct alignas(64) RingSlot { std::atomic<uint64_t> seq; MarketRecord rec; };
+
+struct RingHeader {
+    std::atomic<uint64_t> magic; uint32_t version, record_size; uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> head;  // records ever written
+};
+
+inline uint64_t wall_clock_ns() { return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count(); }
+
+constexpr uint64_t RING_MAGIC = 0x474e495244544b4dULL; // "MKTDRING"
+inline size_t ring_bytes(uint64_t capacity) { return sizeof(RingHeader) + capacity * sizeof(RingSlot); }
+
+class MarketDataRing {
+private:
+    std::string name; RingHeader* hdr = nullptr; RingSlot* slots = nullptr; uint64_t mask = 0, head = 0; size_t bytes = 0;
+
+public:
+    // Publishing is opt-in: SIM_SHM=<name> (e.g. /marketsim), SIM_SHM_SLOTS=<power of two>.
+    MarketDataRing() {
+        if (const char* n = std::getenv("SIM_SHM")) {
+            uint64_t slots = 1 << 16;
+            if (const char* s = std::getenv("SIM_SHM_SLOTS")) slots = std::strtoull(s, nullptr, 10);
+            open(n, slots);
+        }
+    }
+    ~MarketDataRing() { close(); }
+    MarketDataRing(const MarketDataRing&) = delete;
+    MarketDataRing& operator=(const MarketDataRing&) = delete;
+
+    bool open(const std::string& shm_name, uint64_t capacity) {
+        close();
+        if (capacity < 2 || (capacity & (capacity - 1))) { std::fprintf(stderr, "MarketDataRing: capacity must be a power of two\n"); return false; }
+        int fd = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) { std::fprintf(stderr, "MarketDataRing: cannot open %s\n", shm_name.c_str()); return false; }
+        bytes = ring_bytes(capacity);
+        void* p = ftruncate(fd, bytes) == 0 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (p == MAP_FAILED) { std::fprintf(stderr, "MarketDataRing: cannot map %s\n", shm_name.c_str()); shm_unlink(shm_name.c_str()); return false; }
+        name = shm_name; hdr = static_cast<RingHeader*>(p); slots = reinterpret_cast<RingSlot*>(hdr + 1); mask = capacity - 1; head = 0;
+        // Readers attach only once magic is visible, after the rest of the header.
+        hdr->magic.store(0, std::memory_order_relaxed); hdr->version = 2; hdr->record_size = sizeof(MarketRecord); hdr->capacity = capacity;
+        for (uint64_t i = 0; i < capacity; ++i) slots[i].seq.store(0, std::memory_order_relaxed);
+        hdr->head.store(0, std::memory_order_relaxed);
+        hdr->magic.store(RING_MAGIC, std::memory_order_release);
+        return true;
+    }
+    bool enabled() const { return hdr != nullptr; }
+
+    void write(const MarketRecord& r) {
+        if (!hdr) return;
+        RingSlot& s = slots[head & mask];
+        s.seq.store(2 * head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&s.rec, &r, sizeof(r));
+        s.seq.store(2 * head + 2, std::memory_order_release);
+        hdr->head.store(++head, std::memory_order_release);
+    }
+
+    void write(RecordType type, int32_t symbol, std::initializer_list<double> values, const char* tag = "") {
+        if (!hdr) return;
+        MarketRecord r{}; r.type = type; r.symbol = symbol; r.ts_ns = wall_clock_ns();
+        size_t i = 0; for (double v : values) if (i < 10) r.v[i++] = v;
+        std::strncpy(r.tag, tag, sizeof(r.tag) - 1);
+        write(r);
+    }
+
+    void close() {
+        if (!hdr) return;
+        munmap(hdr, bytes); shm_unlink(name.c_str());
+        hdr = nullptr; slots = nullptr;
+    }
+};
+
+// Reader: after attach() each poll is a few loads and one record copy, no syscalls. poll() returns false when caught up;
+// lost() counts records skipped because the writer lapped this reader.
+class MarketDataReader {
+private:
+    const RingHeader* hdr = nullptr; const RingSlot* slots = nullptr; uint64_t mask = 0, next = 0, dropped = 0; size_t bytes = 0;
+
+public:
+    ~MarketDataReader() { if (hdr) munmap(const_cast<RingHeader*>(hdr), bytes); }
+
+    // Starts at the oldest record still in the ring unless from_now is set.
+    bool attach(const std::string& shm_name, bool from_now = false) {
+        int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st; void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(RingHeader)) p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        auto h = static_cast<const RingHeader*>(p);
+        if (h->magic.load(std::memory_order_acquire) != RING_MAGIC || h->record_size != sizeof(MarketRecord) || ring_bytes(h->capacity) > (size_t)st.st_size) { munmap(p, st.st_size); return false; }
+        hdr = h; bytes = st.st_size; slots = reinterpret_cast<const RingSlot*>(hdr + 1); mask = hdr->capacity - 1;
+        uint64_t head = hdr->head.load(std::memory_order_acquire);
+        if (from_now) next = head; else next = head > hdr->capacity ? head - hdr->capacity : 0;
+        return true;
+    }
+
+    bool poll(MarketRecord& out) {
+        while (true) {
+            uint64_t head = hdr->head.load(std::memory_order_acquire);
+            if (next >= head) return false;
+            if (head - next > mask + 1) { dropped += head - next - (mask + 1); next = head - (mask + 1); }
+            const RingSlot& s = slots[next & mask];
+            uint64_t expect = 2 * next + 2, s1 = s.seq.load(std::memory_order_acquire);
+            if (s1 == expect) {
+                std::memcpy(&out, &s.rec, sizeof(out));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s.seq.load(std::memory_order_relaxed) == expect) { ++next; return true; }
+            }
+            // Slot already reused by a later lap: skip what was lost and retry.
+            ++dropped; ++next;
+        }
+    }
+
+    uint64_t lost() const { return dropped; }
+};
+#endif
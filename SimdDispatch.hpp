@@ -0,0 +1,14 @@
+#ifndef SIMD_DISPATCH_HPP
+#define SIMD_DISPATCH_HPP
+
+// Runtime CPU dispatch for SIMD kernels. Portable builds compile each tagged
+// function twice (AVX2 + baseline) and the loader picks one via ifunc, so one
+// binary runs everywhere and still uses AVX2 where present. -march=native
+// builds (make native) define SIM_NATIVE and compile the kernel once for the host.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && !defined(SIM_NATIVE)
+#define SIM_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define SIM_TARGET_CLONES
+#endif
+
+#endif
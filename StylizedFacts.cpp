@@ -0,0 +1,268 @@
+#include "TickRecorder.hpp"
+#include "SimdDispatch.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Offline stylized-facts analyzer for runs recorded with SIM_RECORD=<file>.
+//   stylized_facts [--lags N] [--interval K] [--tail F] [--threads T] [--acf-out acf.csv] run1.bin [run2.bin ...]
+// Runs are analyzed in parallel; within a run the ACF is computed block-wise with FFTs,
+// so cost is O(n log B) regardless of lag count. Memory is not bounded by B: each run in
+// flight holds two n-length double arrays (n sampled returns) plus O(B) FFT buffers per
+// worker, so peak memory is O(n * threads).
+
+using cd = std::complex<double>;
+
+struct Options {
+    int lags = 100; int interval = 1; double tail = 0.05;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string acf_out; std::vector<std::string> files;
+};
+
+struct RunFacts {
+    std::string file; bool ok = false; std::string error;
+    size_t ticks = 0, returns = 0;
+    double mean = 0, stdev = 0, skew = 0, kurtosis = 0;
+    double hill_left = NAN, hill_right = NAN, volume_volatility_corr = NAN;
+    std::vector<double> quantiles, acf_ret, acf_abs;
+};
+
+static const double QUANTILES[] = {0.001, 0.01, 0.05, 0.5, 0.95, 0.99, 0.999};
+static const int REPORT_LAGS[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+
+// Runs fn(i, worker) for i in [0, n) on up to `threads` workers.
+static void parallel_for(size_t n, int threads, const std::function<void(size_t, int)>& fn) {
+    std::atomic<size_t> next{0};
+    auto worker = [&](int w) { for (size_t i; (i = next++) < n;) fn(i, w); };
+    int count = (int)std::min<size_t>(std::max(1, threads), std::max<size_t>(1, n));
+    std::vector<std::thread> pool; for (int w = 1; w < count; ++w) pool.emplace_back(worker, w);
+    worker(0); for (auto& t : pool) t.join();
+}
+
+// Iterative radix-2 FFT with precomputed twiddles and bit-reversal table.
+class FFT {
+    size_t n; std::vector<cd> twiddle; std::vector<uint32_t> rev;
+public:
+    explicit FFT(size_t size) : n(size), twiddle(size / 2), rev(size) {
+        int bits = 0; while ((size_t(1) << bits) < n) ++bits;
+        for (size_t k = 0; k < n / 2; ++k) twiddle[k] = std::polar(1.0, -2.0 * M_PI * k / n);
+        for (size_t i = 0; i < n; ++i) { uint32_t r = 0; for (int b = 0; b < bits; ++b) if (i & (size_t(1) << b)) r |= 1u << (bits - 1 - b); rev[i] = r; }
+    }
+    size_t size() const { return n; }
+    SIM_TARGET_CLONES void transform(std::vector<cd>& a, bool inverse) const {
+        for (size_t i = 0; i < n; ++i) if (i < rev[i]) std::swap(a[i], a[rev[i]]);
+        for (size_t len = 2; len <= n; len <<= 1) {
+            size_t half = len / 2, step = n / len;
+            for (size_t i = 0; i < n; i += len) {
+                for (size_t j = 0; j < half; ++j) {
+                    cd w = inverse ? std::conj(twiddle[j * step]) : twiddle[j * step];
+                    cd u = a[i + j], v = a[i + j + half] * w;
+                    a[i + j] = u + v; a[i + j + half] = u - v;
+                }
+            }
+        }
+        if (inverse) { double inv = 1.0 / n; for (auto& x : a) x *= inv; }
+    }
+};
+
+// Autocovariance sums c[k] = sum_t x_t x_{t+k}, k <= lags, for two real series at once.
+// Both series are packed into one complex signal; each block of B samples is correlated
+// against itself plus the next `lags` samples, so three FFTs of size M >= B + lags cover it.
+static void blocked_autocovariance(const std::vector<double>& x, const std::vector<double>& y, int lags, int threads,
+                                   std::vector<double>& cx, std::vector<double>& cy) {
+    size_t n = x.size(), M = 1 << 16;
+    while (M < 4 * (size_t)lags) M <<= 1;
+    size_t B = M - lags, blocks = (n + B - 1) / B;
+    FFT fft(M);
+    int workers = (int)std::min<size_t>(std::max(1, threads), std::max<size_t>(1, blocks));
+    std::vector<std::vector<double>> acc_x(workers, std::vector<double>(lags + 1, 0.0)), acc_y = acc_x;
+    std::vector<std::vector<cd>> buf_a(workers, std::vector<cd>(M)), buf_y = buf_a;
+
+    parallel_for(blocks, workers, [&](size_t blk, int w) {
+        auto& A = buf_a[w]; auto& Y = buf_y[w];
+        size_t s = blk * B, b = std::min(B, n - s), e = std::min(n - s, b + lags);
+        for (size_t t = 0; t < M; ++t) {
+            A[t] = t < b ? cd(x[s + t], y[s + t]) : cd(0, 0);
+            Y[t] = t < e ? cd(x[s + t], y[s + t]) : cd(0, 0);
+        }
+        fft.transform(A, false); fft.transform(Y, false);
+        for (size_t f = 0; f <= M / 2; ++f) {
+            size_t g = (M - f) & (M - 1);
+            cd a1 = 0.5 * (A[f] + std::conj(A[g])), a2 = cd(0, -0.5) * (A[f] - std::conj(A[g]));
+            cd y1 = 0.5 * (Y[f] + std::conj(Y[g])), y2 = cd(0, -0.5) * (Y[f] - std::conj(Y[g]));
+            cd p1 = std::conj(a1) * y1, p2 = std::conj(a2) * y2;
+            A[f] = p1 + cd(0, 1) * p2;
+            if (g != f) A[g] = std::conj(p1) + cd(0, 1) * std::conj(p2);
+        }
+        fft.transform(A, true);
+        for (int k = 0; k <= lags; ++k) { acc_x[w][k] += A[k].real(); acc_y[w][k] += A[k].imag(); }
+    });
+
+    cx.assign(lags + 1, 0.0); cy.assign(lags + 1, 0.0);
+    for (int w = 0; w < workers; ++w) for (int k = 0; k <= lags; ++k) { cx[k] += acc_x[w][k]; cy[k] += acc_y[w][k]; }
+}
+
+// Hill estimator of the tail index over the largest `tail` fraction of positive samples.
+static double hill_index(std::vector<double>& v, double tail) {
+    if (v.size() < 10) return NAN;
+    size_t k = std::max<size_t>(1, (size_t)(tail * v.size())); if (k >= v.size()) k = v.size() - 1;
+    std::nth_element(v.begin(), v.begin() + k, v.end(), std::greater<double>());
+    double threshold = v[k]; if (threshold <= 0) return NAN;
+    double sum = 0; for (size_t i = 0; i < k; ++i) sum += std::log(v[i] / threshold);
+    return sum > 0 ? k / sum : NAN;
+}
+
+static RunFacts analyze(const std::string& path, const Options& opt, int threads) {
+    RunFacts rf; rf.file = path;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { rf.error = "cannot open"; return rf; }
+    struct stat st;
+    if (fstat(fd, &st) < 0) { ::close(fd); rf.error = "cannot stat"; return rf; }
+    size_t count = st.st_size / sizeof(TickRecord);
+    if (count < 2) { ::close(fd); rf.error = "too few ticks"; return rf; }
+    void* mem = mmap(nullptr, count * sizeof(TickRecord), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) { rf.error = "mmap failed"; return rf; }
+    madvise(mem, count * sizeof(TickRecord), MADV_SEQUENTIAL);
+    const TickRecord* rec = static_cast<const TickRecord*>(mem);
+    rf.ticks = count;
+
+    // Log returns and summed volume per sampling interval
+    size_t K = std::max(1, opt.interval), n = (count - 1) / K;
+    std::vector<double> ret, vol; ret.reserve(n); vol.reserve(n);
+    for (size_t j = 0; j < n; ++j) {
+        double p0 = rec[j * K].price, p1 = rec[(j + 1) * K].price;
+        if (p0 <= 0 || p1 <= 0) continue;
+        uint64_t v = 0; for (size_t t = j * K + 1; t <= (j + 1) * K; ++t) v += rec[t].volume;
+        ret.push_back(std::log(p1 / p0)); vol.push_back((double)v);
+    }
+    munmap(mem, count * sizeof(TickRecord));
+    n = ret.size(); rf.returns = n;
+    if (n < 10) { rf.error = "too few returns"; return rf; }
+
+    double m1 = 0, mabs = 0, mv = 0;
+    for (size_t i = 0; i < n; ++i) { m1 += ret[i]; mabs += std::abs(ret[i]); mv += vol[i]; }
+    m1 /= n; mabs /= n; mv /= n;
+    double m2 = 0, m3 = 0, m4 = 0, cov_va = 0, var_a = 0, var_v = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double d = ret[i] - m1, d2 = d * d; m2 += d2; m3 += d2 * d; m4 += d2 * d2;
+        double da = std::abs(ret[i]) - mabs, dv = vol[i] - mv; cov_va += da * dv; var_a += da * da; var_v += dv * dv;
+    }
+    m2 /= n; m3 /= n; m4 /= n;
+    rf.mean = m1; rf.stdev = std::sqrt(m2);
+    rf.skew = m2 > 0 ? m3 / std::pow(m2, 1.5) : 0; rf.kurtosis = m2 > 0 ? m4 / (m2 * m2) - 3.0 : 0;
+    rf.volume_volatility_corr = (var_a > 0 && var_v > 0) ? cov_va / std::sqrt(var_a * var_v) : NAN;
+    std::vector<double>().swap(vol);
+
+    // Distribution: quantiles in units of sigma, then Hill indices on each tail
+    std::vector<double> scratch(ret);
+    for (double q : QUANTILES) {
+        size_t idx = std::min(n - 1, (size_t)(q * n));
+        std::nth_element(scratch.begin(), scratch.begin() + idx, scratch.end());
+        rf.quantiles.push_back(rf.stdev > 0 ? (scratch[idx] - m1) / rf.stdev : 0);
+    }
+    scratch.clear(); for (double r : ret) if (r > 0) scratch.push_back(r);
+    rf.hill_right = hill_index(scratch, opt.tail);
+    scratch.clear(); for (double r : ret) if (r < 0) scratch.push_back(-r);
+    rf.hill_left = hill_index(scratch, opt.tail);
+    std::vector<double>().swap(scratch);
+
+    // ACF of returns and |returns|
+    int lags = (int)std::min<size_t>(opt.lags, n - 1);
+    std::vector<double> y(n);
+    for (size_t i = 0; i < n; ++i) { y[i] = std::abs(ret[i]) - mabs; ret[i] -= m1; }
+    std::vector<double> cx, cy; blocked_autocovariance(ret, y, lags, threads, cx, cy);
+    rf.acf_ret.resize(lags + 1); rf.acf_abs.resize(lags + 1);
+    for (int k = 0; k <= lags; ++k) { rf.acf_ret[k] = cx[0] > 0 ? cx[k] / cx[0] : 0; rf.acf_abs[k] = cy[0] > 0 ? cy[k] / cy[0] : 0; }
+    rf.ok = true;
+    return rf;
+}
+
+static void print_acf_rows(const std::vector<double>& acf_ret, const std::vector<double>& acf_abs) {
+    int lags = (int)acf_ret.size() - 1;
+    std::cout << "  ACF lag     "; for (int l : REPORT_LAGS) if (l <= lags) std::cout << std::setw(9) << l; std::cout << "\n";
+    std::cout << "    returns   "; for (int l : REPORT_LAGS) if (l <= lags) std::cout << std::setw(9) << acf_ret[l]; std::cout << "\n";
+    std::cout << "    |returns| "; for (int l : REPORT_LAGS) if (l <= lags) std::cout << std::setw(9) << acf_abs[l]; std::cout << "\n";
+}
+
+static void print_run(const RunFacts& rf, const Options& opt) {
+    std::cout << "== " << rf.file << " ==\n";
+    if (!rf.ok) { std::cout << "  error: " << rf.error << "\n"; return; }
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "  ticks " << rf.ticks << "  returns " << rf.returns << " (interval " << opt.interval << ")\n";
+    std::cout << "  returns: mean " << std::scientific << std::setprecision(3) << rf.mean << "  stdev " << rf.stdev
+              << std::fixed << std::setprecision(4) << "  skew " << rf.skew << "  excess kurtosis " << rf.kurtosis << "\n";
+    std::cout << "  quantiles (sigma):"; for (size_t i = 0; i < rf.quantiles.size(); ++i) std::cout << "  q" << QUANTILES[i] << " " << rf.quantiles[i]; std::cout << "\n";
+    std::cout << "  Hill tail index (top " << opt.tail * 100 << "%): left " << rf.hill_left << "  right " << rf.hill_right << "\n";
+    print_acf_rows(rf.acf_ret, rf.acf_abs);
+    std::cout << "  volume-|return| correlation " << rf.volume_volatility_corr << "\n";
+}
+
+static void mean_sd(const std::vector<RunFacts>& runs, double RunFacts::*field, double& mean, double& sd) {
+    std::vector<double> v; for (auto& r : runs) if (r.ok && std::isfinite(r.*field)) v.push_back(r.*field);
+    mean = sd = NAN; if (v.empty()) return;
+    mean = 0; for (double x : v) mean += x; mean /= v.size();
+    sd = 0; for (double x : v) sd += (x - mean) * (x - mean); sd = v.size() > 1 ? std::sqrt(sd / (v.size() - 1)) : 0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string { if (i + 1 >= argc) { std::cerr << "missing value for " << a << "\n"; std::exit(1); } return argv[++i]; };
+        if (a == "--lags") opt.lags = std::max(1, std::stoi(next()));
+        else if (a == "--interval") opt.interval = std::max(1, std::stoi(next()));
+        else if (a == "--tail") opt.tail = std::stod(next());
+        else if (a == "--threads") opt.threads = std::max(1, std::stoi(next()));
+        else if (a == "--acf-out") opt.acf_out = next();
+        else if (a == "-h" || a == "--help") { std::cout << "usage: stylized_facts [--lags N] [--interval K] [--tail F] [--threads T] [--acf-out acf.csv] run.bin...\n"; return 0; }
+        else opt.files.push_back(a);
+    }
+    if (opt.files.empty()) { std::cerr << "no recorded runs given (record with SIM_RECORD=<file>)\n"; return 1; }
+
+    // Spread threads over runs first; leftover threads go to each run's ACF blocks
+    std::vector<RunFacts> runs(opt.files.size());
+    int outer = std::min<int>(opt.threads, (int)runs.size()), inner = std::max(1, opt.threads / outer);
+    auto t0 = std::chrono::steady_clock::now();
+    parallel_for(runs.size(), outer, [&](size_t i, int) { runs[i] = analyze(opt.files[i], opt, inner); });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (auto& rf : runs) print_run(rf, opt);
+
+    std::vector<double> acf_ret(opt.lags + 1, 0.0), acf_abs(opt.lags + 1, 0.0); std::vector<int> acf_n(opt.lags + 1, 0);
+    for (auto& rf : runs) if (rf.ok) for (size_t k = 0; k < rf.acf_ret.size(); ++k) { acf_ret[k] += rf.acf_ret[k]; acf_abs[k] += rf.acf_abs[k]; acf_n[k]++; }
+    int max_lag = 0; for (int k = 0; k <= opt.lags; ++k) if (acf_n[k]) { acf_ret[k] /= acf_n[k]; acf_abs[k] /= acf_n[k]; max_lag = k; }
+    acf_ret.resize(max_lag + 1); acf_abs.resize(max_lag + 1);
+
+    if (runs.size() > 1) {
+        std::cout << "== aggregate over " << runs.size() << " runs (mean +- sd) ==\n" << std::fixed << std::setprecision(4);
+        double m, s;
+        mean_sd(runs, &RunFacts::kurtosis, m, s); std::cout << "  excess kurtosis " << m << " +- " << s << "\n";
+        mean_sd(runs, &RunFacts::hill_left, m, s); std::cout << "  Hill left " << m << " +- " << s;
+        mean_sd(runs, &RunFacts::hill_right, m, s); std::cout << "  right " << m << " +- " << s << "\n";
+        mean_sd(runs, &RunFacts::volume_volatility_corr, m, s); std::cout << "  volume-|return| correlation " << m << " +- " << s << "\n";
+        print_acf_rows(acf_ret, acf_abs);
+    }
+    if (!opt.acf_out.empty()) {
+        std::ofstream out(opt.acf_out);
+        out << "lag,acf_returns,acf_abs_returns\n" << std::setprecision(8);
+        for (int k = 0; k <= max_lag; ++k) out << k << "," << acf_ret[k] << "," << acf_abs[k] << "\n";
+    }
+    std::cout << "analyzed " << runs.size() << " run(s) in " << std::setprecision(3) << secs << "s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef TICK_RECORDER_HPP
+#define TICK_RECORDER_HPP
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// One fixed-size record per simulation tick. Files are a flat array of these,
+// so analysis tools can mmap them directly.
+struct TickRecord { double time; double price; uint64_t volume; };
+
+class TickRecorder {
+private:
+    FILE* file = nullptr;
+    std::vector<TickRecord> buffer;
+
+public:
+    // Recording is opt-in: set SIM_RECORD=<path> before launching an engine.
+    TickRecorder() { if (const char* path = std::getenv("SIM_RECORD")) open(path); }
+    ~TickRecorder() { close(); }
+    TickRecorder(const TickRecorder&) = delete;
+    TickRecorder& operator=(const TickRecorder&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) { std::fprintf(stderr, "TickRecorder: cannot open %s\n", path.c_str()); return false; }
+        buffer.reserve(1 << 16);
+        return true;
+    }
+    bool enabled() const { return file != nullptr; }
+
+    void record(double time, double price, uint64_t volume) {
+        if (!file) return;
+        buffer.push_back({time, price, volume});
+        if (buffer.size() == buffer.capacity()) flush();
+    }
+
+    void flush() {
+        if (!file || buffer.empty()) return;
+        std::fwrite(buffer.data(), sizeof(TickRecord), buffer.size(), file);
+        buffer.clear();
+    }
+
+    void close() { if (file) { flush(); std::fclose(file); file = nullptr; } }
+};
+#endif
@@ -0,0 +1,75 @@
+#ifndef TIMING_WHEEL_HPP
+#define TIMING_WHEEL_HPP
+
+#include "MemoryAccounting.hpp"
+#include <vector>
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+#include <iterator>
+
+// Delayed delivery keyed by integer nanoseconds: a hashed wheel of `slots` buckets, each
+// `bucket_ns` wide, covering one revolution ahead of the cursor, plus an overflow list for
+// anything further out that is pulled in at revolution boundaries. push() is O(1) and
+// flags its bucket if it lands out of (time, push) order. advance() visits each elapsed
+// bucket once (jumping straight over idle stretches) and sorts only flagged buckets, so
+// releases are O(1) amortized when items arrive in time order (a fixed delay) and
+// O(log k) per item for a bucket of k jittered arrivals.
+template <typename T>
+class TimingWheel {
+private:
+    struct Item { int64_t t_ns; uint64_t seq; T value; };
+    std::vector<std::vector<Item>> wheel; std::vector<uint8_t> unsorted; std::vector<Item> overflow, ready;
+    int64_t bucket_ns, cursor = 0; size_t mask; uint64_t seq = 0; size_t in_wheel = 0;
+
+    static bool later(const Item& a, const Item& b) { return a.t_ns != b.t_ns ? a.t_ns > b.t_ns : a.seq > b.seq; }
+    void place(Item&& it) {
+        int64_t b = std::max(cursor, it.t_ns / bucket_ns);
+        if (b - cursor >= (int64_t)wheel.size()) { overflow.push_back(std::move(it)); return; }
+        auto& slot = wheel[b & mask];
+        if (!slot.empty() && later(slot.back(), it)) unsorted[b & mask] = 1;
+        slot.push_back(std::move(it)); ++in_wheel;
+    }
+    void refill() {
+        size_t keep = 0;
+        for (auto& it : overflow) { if (it.t_ns / bucket_ns - cursor < (int64_t)wheel.size()) place(std::move(it)); else overflow[keep++] = std::move(it); }
+        overflow.resize(keep);
+    }
+    template <typename F> void release(size_t b, int64_t limit, F& fn) {
+        auto& slot = wheel[b];
+        if (unsorted[b]) { std::sort(slot.begin(), slot.end(), [](const Item& x, const Item& y) { return later(y, x); }); unsorted[b] = 0; }
+        // Moved out before the callbacks, which may push
+        size_t k = 0; while (k < slot.size() && slot[k].t_ns <= limit) ++k;
+        ready.assign(std::make_move_iterator(slot.begin()), std::make_move_iterator(slot.begin() + k));
+        slot.erase(slot.begin(), slot.begin() + k); in_wheel -= k;
+        for (auto& it : ready) fn(it.t_ns, it.value);
+    }
+
+public:
+    // slots is rounded up to a power of two
+    explicit TimingWheel(int64_t bucket_ns = 1000000, size_t slots = 4096) : bucket_ns(bucket_ns) {
+        size_t n = 1; while (n < slots) n <<= 1;
+        wheel.resize(n); unsorted.assign(n, 0); mask = n - 1;
+    }
+
+    // Items already due are released by the next advance()
+    void push(int64_t t_ns, T value) { place(Item{t_ns, seq++, std::move(value)}); }
+    size_t size() const { return in_wheel + overflow.size(); }
+    size_t memory_bytes() const { size_t b = vector_bytes(wheel) + vector_bytes(unsorted) + vector_bytes(overflow) + vector_bytes(ready); for (auto& s : wheel) b += vector_bytes(s); return b; }
+
+    // Calls fn(t_ns, value) for everything due at or before now_ns, in time order
+    template <typename F> void advance(int64_t now_ns, F&& fn) {
+        int64_t now_b = now_ns / bucket_ns;
+        while (true) {
+            if (in_wheel == 0) {
+                int64_t next = now_b;
+                for (auto& it : overflow) next = std::min(next, it.t_ns / bucket_ns);
+                if (next > cursor) { cursor = next; refill(); }
+            }
+            if (!wheel[cursor & mask].empty()) release(cursor & mask, cursor < now_b ? INT64_MAX : now_ns, fn);
+            if (cursor >= now_b) return;
+            if ((++cursor & (int64_t)mask) == 0) refill();
+        }
+    }
+};
+#endif
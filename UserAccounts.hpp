@@ -0,0 +1,108 @@
+#ifndef USER_ACCOUNTS_HPP
+#define USER_ACCOUNTS_HPP
+
+#include "LimitOrderBook.hpp"
+#include "AgentLedger.hpp"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+struct OpenOrder { uint64_t id; Side side; double price; uint32_t remaining; };
+struct UserFill { uint32_t user; uint64_t order_id; bool is_buy; uint32_t quantity; double price; };
+struct AccountSnapshot { uint32_t user; int64_t position; double cash, realized, unrealized; const std::vector<OpenOrder>& open; };
+
+// Authoritative state for human users: ledger account, resting orders and fills.
+// Users are created on first order. Changes mark an account dirty; publish() emits
+// only dirty accounts (plus any holding a position, whose P&L moves with the mark),
+// so cost per publish is proportional to active users, not to trade history.
+class UserAccounts {
+private:
+    struct Account { uint32_t user; uint32_t ledger_account; std::vector<OpenOrder> open; bool dirty = true; };
+    std::vector<Account> accounts;
+    std::unordered_map<uint32_t, uint32_t> by_user;     // user id -> slot
+    std::unordered_map<uint32_t, uint32_t> by_ledger;   // ledger account -> slot
+    std::unordered_map<uint64_t, uint32_t> open_owner;  // resting order id -> slot
+    std::vector<UserFill> fills;
+
+    void remove_open(Account& a, uint64_t id) {
+        a.open.erase(std::remove_if(a.open.begin(), a.open.end(), [id](const OpenOrder& o) { return o.id == id; }), a.open.end());
+        open_owner.erase(id);
+    }
+
+public:
+    uint32_t ledger_account(uint32_t user, AgentLedger& ledger) {
+        auto it = by_user.find(user);
+        if (it != by_user.end()) return accounts[it->second].ledger_account;
+        uint32_t slot = (uint32_t)accounts.size(), acct = ledger.add_account(AgentClass::USER);
+        accounts.push_back({user, acct, {}, true});
+        by_user[user] = slot; by_ledger[acct] = slot;
+        return acct;
+    }
+
+    // Call after book.add_order(incoming) with the trades it produced, for every order
+    // (agent or user): a user's resting order can be hit by anyone.
+    void on_trades(const Order& incoming, const std::vector<Trade>& trades) {
+        auto in = by_ledger.find(incoming.owner);
+        uint32_t filled = 0;
+        for (auto& t : trades) {
+            filled += t.quantity;
+            if (in != by_ledger.end()) fills.push_back({accounts[in->second].user, incoming.id, incoming.side == Side::BUY, t.quantity, t.price});
+            if (open_owner.empty()) continue;
+            auto rest = open_owner.find(t.resting_id);
+            if (rest == open_owner.end()) continue;
+            Account& a = accounts[rest->second]; a.dirty = true;
+            for (auto& o : a.open) {
+                if (o.id != t.resting_id) continue;
+                fills.push_back({a.user, o.id, o.side == Side::BUY, t.quantity, t.price});
+                o.remaining -= std::min(o.remaining, t.quantity);
+                if (o.remaining == 0) remove_open(a, t.resting_id);
+                break;
+            }
+        }
+        if (in == by_ledger.end()) return;
+        Account& a = accounts[in->second]; a.dirty = true;
+        if (incoming.quantity > filled) {
+            a.open.push_back({incoming.id, incoming.side, incoming.price, incoming.quantity - filled});
+            open_owner[incoming.id] = in->second;
+        }
+    }
+
+    bool cancel(uint32_t user, uint64_t order_id, LimitOrderBook& book) {
+        auto it = by_user.find(user); auto own = open_owner.find(order_id);
+        if (it == by_user.end() || own == open_owner.end() || own->second != it->second) return false;
+        book.cancel(order_id);
+        Account& a = accounts[it->second]; remove_open(a, order_id); a.dirty = true;
+        return true;
+    }
+
+    // Drops resting orders the book no longer holds (e.g. removed by decay).
+    void sweep(const LimitOrderBook& book) {
+        for (auto& a : accounts) {
+            size_t before = a.open.size();
+            for (auto& o : a.open) if (!book.is_active(o.id)) open_owner.erase(o.id);
+            a.open.erase(std::remove_if(a.open.begin(), a.open.end(), [&](const OpenOrder& o) { return !book.is_active(o.id); }), a.open.end());
+            if (a.open.size() != before) a.dirty = true;
+        }
+    }
+
+    // Resting orders of a user, or nullptr for a user that has never traded
+    const std::vector<OpenOrder>* open_orders(uint32_t user) const { auto it = by_user.find(user); return it == by_user.end() ? nullptr : &accounts[it->second].open; }
+    template <class F> void drain_fills(F&& fn) { for (auto& f : fills) fn(f); fills.clear(); }
+    size_t count() const { return accounts.size(); }
+    size_t memory_bytes() const {
+        size_t b = vector_bytes(accounts) + hash_bytes(by_user) + hash_bytes(by_ledger) + hash_bytes(open_owner) + vector_bytes(fills);
+        for (auto& a : accounts) b += vector_bytes(a.open);
+        return b;
+    }
+
+    template <class F> void publish(const AgentLedger& ledger, double mark, F&& fn) {
+        for (auto& a : accounts) {
+            uint32_t l = a.ledger_account;
+            if (!a.dirty && ledger.position[l] == 0) continue;
+            fn(AccountSnapshot{a.user, ledger.position[l], ledger.cash[l], ledger.realized[l], ledger.unrealized(l, mark), a.open});
+            a.dirty = false;
+        }
+    }
+};
+#endif
@@ -0,0 +1,126 @@
+#ifndef VEC_ENV_HPP
+#define VEC_ENV_HPP
+
+#include "MarketSimulation.hpp"
+#include "ShardPool.hpp"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+// Gym-style vectorized environment: B independent very volatile markets stepped in
+// lockstep on a ShardPool. The trained strategy is user TRAINER in every market. Actions,
+// observations, rewards and done flags are contiguous arrays indexed by env (observations
+// row-major, OBS_DIM per env), so a batch crosses into a learner without copies.
+//     VecMarketEnv env(VecEnvConfig{...});
+//     env.reset();
+//     while (training) { fill(env.actions); env.step(); learn(env.obs, env.rewards, env.dones); }
+// An episode runs episode_ticks engine ticks, rounded up to whole steps of ticks_per_step.
+// A finished env resets on its own with the next seed of its stream, and its row then holds
+// the new episode's first observation.
+
+struct EnvAction {
+    int32_t quantity = 0; // > 0 buy, < 0 sell, 0 no order
+    double offset = 0.0;  // limit price = mid * (1 + offset)
+    int32_t cancel = 0;   // non-zero: cancel the trainer's resting orders first
+};
+
+enum Obs { OBS_MID, OBS_LAST, OBS_SPREAD, OBS_BID_SIZE, OBS_ASK_SIZE, OBS_VOLUME, OBS_VOL, OBS_POSITION, OBS_CASH, OBS_UNREALIZED, OBS_OPEN, OBS_DIM };
+
+struct VecEnvConfig {
+    int envs = 64;
+    SimConfig population{20, 20, 15, 30};
+    int episode_ticks = 1000, ticks_per_step = 1, warmup_ticks = 50;
+    MarketScenario scenario = MarketScenario::NORMAL;
+    uint32_t seed = 1;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+class VecMarketEnv {
+public:
+    static constexpr uint32_t TRAINER = 1;
+
+    std::vector<EnvAction> actions;
+    std::vector<double> obs, rewards; // obs: envs x OBS_DIM
+    std::vector<uint8_t> dones;
+
+    explicit VecMarketEnv(const VecEnvConfig& c) : actions(c.envs), obs((size_t)c.envs * OBS_DIM), rewards(c.envs), dones(c.envs), cfg(c), pool(std::min(c.threads, std::max(1, c.envs))), envs(c.envs) {}
+
+    int size() const { return cfg.envs; }
+    uint64_t steps() const { return total_steps; }
+
+    void reset() { pool.for_each_shard(envs.size(), [&](size_t i) { restart(i); observe(i); }); }
+
+    // One step of every env: queue its action, run ticks_per_step ticks, observe
+    void step() {
+        pool.for_each_shard(envs.size(), [&](size_t i) {
+            Env& e = envs[i]; MarketSimulation& sim = *e.sim; const EnvAction& a = actions[i];
+            e.orders.clear();
+            if (a.cancel) if (auto* open = sim.users.open_orders(TRAINER)) for (auto& o : *open) { UserOrder u{}; u.user = TRAINER; u.cancel_id = o.id; e.orders.push_back(u); }
+            double price = sim.book.get_mid(sim.price) * (1.0 + a.offset);
+            if (a.quantity != 0 && price > 0) e.orders.push_back(UserOrder{a.quantity > 0, std::abs(a.quantity), price, TRAINER});
+            e.volume = 0;
+            for (int t = 0; t < cfg.ticks_per_step; ++t) { sim.step(t == 0 ? e.orders : none, e.out); e.volume += sim.tick_volume; }
+            double pnl = mark(i); rewards[i] = pnl - e.pnl; e.pnl = pnl;
+            e.tick += cfg.ticks_per_step;
+            dones[i] = e.tick >= cfg.episode_ticks;
+            if (dones[i]) restart(i);
+            observe(i);
+        });
+        total_steps += envs.size();
+    }
+
+private:
+    struct NullSink {
+        void recordTick(double, double, uint64_t) {}
+        void broadcastMetrics(double, long) {}
+        void broadcastFill(const UserFill&) {}
+        void broadcastData(double, uint32_t) {}
+        void broadcastSentiment(long, long, long, long, long, long, long, long, long, long) {}
+        void broadcastScenarioMetrics(double, double, long, double) {}
+        void broadcastPnl(const std::array<double, NUM_AGENT_CLASSES>&, const std::vector<LedgerEntry>&) {}
+        void broadcastAccount(const AccountSnapshot&) {}
+    };
+    struct Env {
+        std::unique_ptr<MarketSimulation> sim; NullSink out; std::vector<UserOrder> orders;
+        uint32_t account = 0, episode = 0; int tick = 0; uint64_t volume = 0; double pnl = 0.0;
+    };
+
+    VecEnvConfig cfg; ShardPool pool;
+    std::vector<Env> envs; const std::vector<UserOrder> none;
+    uint64_t total_steps = 0;
+
+    // Episode k of env i gets its own seed stream: reproducible, and independent across envs
+    void restart(size_t i) {
+        Env& e = envs[i];
+        uint64_t z = ((uint64_t)cfg.seed << 32 | (uint32_t)i) * 0x9E3779B97F4A7C15ULL + (uint64_t)e.episode++ * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 31)) * 0x94D049BB133111EBULL; z ^= z >> 29;
+        SeedSource rd((unsigned int)(z ^ (z >> 32)));
+        e.sim = std::make_unique<MarketSimulation>(cfg.population, rd);
+        MarketSimulation& sim = *e.sim;
+        sim.set_phase(cfg.scenario);
+        e.account = sim.users.ledger_account(TRAINER, sim.ledger);
+        for (int t = 0; t < cfg.warmup_ticks; ++t) sim.step(none, e.out);
+        e.tick = 0; e.volume = sim.tick_volume; e.pnl = 0.0;
+    }
+
+    double mark(size_t i) const { const Env& e = envs[i]; const AgentLedger& l = e.sim->ledger; return l.pnl(e.account, e.sim->price); }
+
+    void observe(size_t i) {
+        Env& e = envs[i]; MarketSimulation& sim = *e.sim; LimitOrderBook& b = sim.book;
+        double* o = &obs[i * OBS_DIM];
+        b.clean_heaps();
+        bool two_sided = !b.askHeap.empty() && !b.bidHeap.empty();
+        o[OBS_MID] = b.get_mid(sim.price); o[OBS_LAST] = sim.price;
+        o[OBS_SPREAD] = two_sided ? b.askHeap.top().price - b.bidHeap.top().price : 0.0;
+        o[OBS_BID_SIZE] = b.bidHeap.empty() ? 0.0 : b.bidHeap.top().quantity;
+        o[OBS_ASK_SIZE] = b.askHeap.empty() ? 0.0 : b.askHeap.top().quantity;
+        o[OBS_VOLUME] = (double)e.volume; o[OBS_VOL] = sim.realized_vol;
+        o[OBS_POSITION] = (double)sim.ledger.position[e.account]; o[OBS_CASH] = sim.ledger.cash[e.account];
+        o[OBS_UNREALIZED] = sim.ledger.unrealized(e.account, sim.price);
+        const std::vector<OpenOrder>* open = sim.users.open_orders(TRAINER);
+        o[OBS_OPEN] = open ? (double)open->size() : 0.0;
+    }
+};
+#endif
@@ -0,0 +1,192 @@
+#ifndef VERY_VOLATILE_AGENTS_HPP
+#define VERY_VOLATILE_AGENTS_HPP
+
+#include "EngineInterface.hpp"
+#include "LimitOrderBook.hpp"
+#include "ScenarioTimeline.hpp"
+#include <optional>
+#include <string>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// Agent populations of the very volatile engine (MarketSimulation.hpp)
+class Agent { 
+public: 
+    virtual ~Agent() = default; 
+    virtual std::optional<Order> act(double mid, double vol, double time, uint64_t& id) = 0; 
+    virtual std::string get_name() = 0; 
+    uint32_t account = 0; // AgentLedger slot
+
+    // Scenario phase, parameters and peak price, shared by all agents of one simulation
+    // (ScenarioTimeline.hpp); set by the owning MarketSimulation
+    const MarketContext* market = nullptr;
+};
+
+class MarketMaker final : public Agent {
+    std::mt19937 gen; std::exponential_distribution<> wake_dist; std::uniform_int_distribution<> size_dist; std::uniform_real_distribution<> spread_jitter; double next_act_time;
+public:
+    MarketMaker(unsigned int seed) : gen(seed), size_dist(100, 500), spread_jitter(0.9, 1.1) { wake_dist = std::exponential_distribution<>(1.0/1.5); next_act_time = 0; }
+    std::string get_name() override { return "MARKET_MAKER"; }
+    double wake_time() const { return next_act_time; }
+    void wake_at(double t) { next_act_time = t; }
+    std::optional<Order> act(double mid, double vol, double time, uint64_t& id) override {
+        if (time < next_act_time) return std::nullopt;
+        next_act_time = time + wake_dist(gen);
+        Side s = (std::uniform_real_distribution<>(0, 1)(gen) > 0.5) ? Side::BUY : Side::SELL;
+        double spread = std::max(0.01, 0.2 * vol * mid) * spread_jitter(gen);
+        
+        // PUMP: Widen spreads to allow vertical moves
+        spread *= market->params.maker_spread_mult;
+
+        double p = (s == Side::BUY) ? mid - spread : mid + spread; if(p<0.01) p=0.01;
+        return Order{id++, time, p, (uint32_t)size_dist(gen), s};
+    }
+};
+
+class FundamentalTrader final : public Agent {
+    std::mt19937 gen; std::exponential_distribution<> wake_dist; double belief_noise; double next_act_time;
+public:
+    FundamentalTrader(unsigned int seed) : gen(seed) { wake_dist = std::exponential_distribution<>(1.0/5.0); std::normal_distribution<> bias(1.0, 0.005); belief_noise = bias(gen); next_act_time = 0; }
+    std::string get_name() override { return "FUNDAMENTAL"; }
+    double wake_time() const { return next_act_time; }
+    void wake_at(double t) { next_act_time = t; }
+    
+    // Instantiated once per scenario; the engine picks the instance when the phase changes
+    template <MarketScenario S>
+    std::optional<Order> act_with_market(double true_value, double current_market_price, double time, uint64_t& id) {
+        // PUMP FIX: Fast wake up (0.5s mean) to ensure activity
+        if (time < next_act_time) return std::nullopt;
+        next_act_time = time + std::exponential_distribution<>(1.0/market->params.fund_wake_mean)(gen);
+        
+        double my_fair_value = true_value * belief_noise * market->params.fund_fair_mult;
+
+        double deviation = (current_market_price - my_fair_value) / my_fair_value;
+        
+        // --- PUMP & DUMP LOGIC ---
+        if constexpr (S == MarketScenario::PUMP_DUMP) {
+            if (std::abs(deviation) < 0.005) return std::nullopt; 
+            
+            // Consistent Volume (60% of normal)
+            uint32_t qty = 50 + static_cast<uint32_t>((std::abs(deviation)/0.02) * 400);
+            qty = std::max(20u, (uint32_t)(qty * 0.6)); 
+            
+            if (deviation > 0) {
+                // Mix of Passive (Ladder) and Aggressive (Market Sell)
+                if (std::uniform_real_distribution<>(0, 1)(gen) < 0.3) {
+                    return Order{id++, time, current_market_price * 0.99, qty, Side::SELL};
+                } else {
+                    std::uniform_real_distribution<> ladder(1.005, 1.02); 
+                    return Order{id++, time, current_market_price * ladder(gen), qty, Side::SELL};
+                }
+            } else {
+                return Order{id++, time, current_market_price * 0.99, qty, Side::BUY};
+            }
+        }
+        // --- SHORT SQUEEZE LOGIC ---
+        else if constexpr (S == MarketScenario::SHORT_SQUEEZE) {
+            if (deviation > 0.15) return Order{id++, time, current_market_price * 1.02, 5000, Side::BUY}; 
+            else if (deviation > 0) {
+                uint32_t qty = 50 + static_cast<uint32_t>(std::min(1.0, std::abs(deviation)/0.02) * 400);
+                qty *= 3; 
+                return Order{id++, time, current_market_price * 0.995, qty, Side::SELL};
+            }
+        }
+        
+        // --- NORMAL LOGIC ---
+        double aggressiveness = std::min(1.0, std::abs(deviation) / 0.02);
+        uint32_t qty = 50 + static_cast<uint32_t>(aggressiveness * 400);
+        if (deviation > 0) return Order{id++, time, (1.0 - aggressiveness) * my_fair_value + aggressiveness * (current_market_price * 0.998), qty, Side::SELL};
+        else return Order{id++, time, (1.0 - aggressiveness) * my_fair_value + aggressiveness * (current_market_price * 1.002), qty, Side::BUY};
+    }
+    std::optional<Order> act(double mid, double vol, double time, uint64_t& id) override { return std::nullopt; }
+};
+
+class NoiseTrader final : public Agent {
+    std::mt19937 gen; std::exponential_distribution<> wake_dist; std::lognormal_distribution<> size_dist; std::normal_distribution<> impact_dist; double next_act_time;
+public:
+    NoiseTrader(unsigned int seed) : gen(seed), size_dist(4.0, 0.5), impact_dist(0.0, 1.0) { wake_dist = std::exponential_distribution<>(1.0/15.0); next_act_time = 0; }
+    std::string get_name() override { return "NOISE"; }
+    double wake_time() const { return next_act_time; }
+    void wake_at(double t) { next_act_time = t; }
+    std::optional<Order> act(double mid, double vol, double time, uint64_t& id) override {
+        switch (market->scenario) {
+            case MarketScenario::PUMP_DUMP: return decide<MarketScenario::PUMP_DUMP>(mid, vol, time, id);
+            case MarketScenario::SHORT_SQUEEZE: return decide<MarketScenario::SHORT_SQUEEZE>(mid, vol, time, id);
+            default: return decide<MarketScenario::NORMAL>(mid, vol, time, id);
+        }
+    }
+    template <MarketScenario S>
+    std::optional<Order> decide(double mid, double vol, double time, uint64_t& id) {
+        if (time < next_act_time) return std::nullopt;
+        
+        next_act_time = time + std::exponential_distribution<>(1.0/15.0 * market->params.noise_wake_speed)(gen);
+        
+        Side s;
+        
+        // --- PUMP & DUMP LOGIC ---
+        if constexpr (S == MarketScenario::PUMP_DUMP) {
+            // CASCADING PANIC LOGIC
+            double drawdown = (market->peak_price > 0) ? (market->peak_price - mid) / market->peak_price : 0.0;
+            
+            // 90% STARTING HYPE (0.9 base)
+            double buy_prob = market->params.noise_hype - (drawdown * 8.0);
+            
+            if (buy_prob < 0.05) {
+                // FULL PANIC
+                s = Side::SELL;
+                uint32_t panic_qty = std::min(2000u, std::max(100u, (uint32_t)size_dist(gen) * 8)); 
+                return Order{id++, time, mid * 0.85, panic_qty, s}; 
+            } 
+            else {
+                // Hype / Wavering State
+                s = (std::uniform_real_distribution<>(0, 1)(gen) < buy_prob) ? Side::BUY : Side::SELL;
+                
+                // JITTER
+                double size_mult = (std::uniform_real_distribution<>(0, 1)(gen) < 0.2) ? 3.0 : 1.5;
+                uint32_t qty = std::min(500u, std::max(1u, (uint32_t)(size_dist(gen) * size_mult)));
+                
+                if (s == Side::BUY) return Order{id++, time, mid * 1.05, qty, s}; 
+                else return Order{id++, time, mid * 0.95, qty, s}; 
+            }
+        }
+        // --- NORMAL / SHORT SQUEEZE LOGIC --- (squeeze: 65% sale probability)
+        else {
+            s = (std::uniform_real_distribution<>(0, 1)(gen) > market->params.noise_sell_prob) ? Side::BUY : Side::SELL;
+        }
+
+        // Common Execution for Normal/Squeeze
+        double impact = std::abs(impact_dist(gen)) * (0.05 + 0.5 * vol) * mid;
+        double p = (s == Side::BUY) ? mid + impact : mid - impact; if(p<0.01) p=0.01;
+        uint32_t qty = std::min(200u, std::max(1u, (uint32_t)size_dist(gen)));
+        return Order{id++, time, p, qty, s};
+    }
+};
+
+class MomentumTrader final : public Agent {
+    std::mt19937 gen; double ema_s, ema_l; double next_act_time; double reaction_speed;
+public:
+    MomentumTrader(unsigned int seed, double p) : gen(seed), ema_s(p), ema_l(p) { reaction_speed = 3.0; next_act_time = 20.0; }
+    std::string get_name() override { return "MOMENTUM"; }
+    double wake_time() const { return next_act_time; }
+    void wake_at(double t) { next_act_time = t; }
+    std::optional<Order> act(double mid, double vol, double time, uint64_t& id) override { observe(mid); return decide(mid, vol, time, id); }
+    // The averages sample once per tick in both kernels; decide() runs at wake-ups
+    void observe(double mid) { ema_s = 0.05 * mid + 0.95 * ema_s; ema_l = 0.01 * mid + 0.99 * ema_l; }
+    std::optional<Order> decide(double mid, double vol, double time, uint64_t& id) {
+        if (time < next_act_time) return std::nullopt;
+        
+        double speed = reaction_speed * market->params.momentum_speed_mult;
+        next_act_time = time + std::exponential_distribution<>(1.0 / speed)(gen);
+        
+        double signal = ema_s - ema_l; double offset = 0.05 * vol * mid;
+        if (signal > offset) return Order{id++, time, mid + offset, 50, Side::BUY}; 
+        if (signal < -offset) return Order{id++, time, mid - offset, 50, Side::SELL};
+        return std::nullopt;
+    }
+};
+
+// Wake event handles: agent class in the top two bits, index within its population below
+enum : uint32_t { WAKE_MAKER = 0u << 30, WAKE_FUND = 1u << 30, WAKE_NOISE = 2u << 30, WAKE_MOM = 3u << 30, WAKE_INDEX = (1u << 30) - 1 };
+#endif
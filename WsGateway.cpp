@@ -0,0 +1,219 @@
+#include "ShmRing.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+// Native market data gateway: reads an engine's shared-memory ring (SIM_SHM) and streams
+// the records to browsers over WebSocket as binary frames, and serves the dashboard so the
+// page can connect directly. Control (start/stop/orders) still goes through server.py.
+// Each client has a conflation map keyed by (type, symbol): records arriving while its
+// previous frame is still being written replace older ones, so slow clients never queue.
+// Per-interval volumes (DATA volume, SENTIMENT) are summed over the replaced records.
+// Frame payload: uint32 count, then count raw MarketRecords (little-endian, 112 bytes each).
+// Usage: ws_gateway --shm /marketsim [--port 8765] [--control http://localhost:8000] [--html templates/index.html]
+
+namespace {
+
+struct Sha1 {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    static uint32_t rol(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+    void block(const unsigned char* p) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 | (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+        for (int i = 16; i < 80; ++i) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            uint32_t t = rol(a, 5) + f + e + k + w[i]; e = d; d = c; c = rol(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    std::string digest(const std::string& msg) {
+        std::string m = msg; uint64_t bits = (uint64_t)msg.size() * 8;
+        m += (char)0x80; while (m.size() % 64 != 56) m += (char)0;
+        for (int i = 7; i >= 0; --i) m += (char)(bits >> (8 * i));
+        for (size_t i = 0; i < m.size(); i += 64) block((const unsigned char*)m.data() + i);
+        std::string out; for (uint32_t x : h) for (int i = 3; i >= 0; --i) out += (char)(x >> (8 * i));
+        return out;
+    }
+};
+
+std::string base64(const std::string& in) {
+    static const char* t = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out; size_t i = 0;
+    for (; i + 2 < in.size(); i += 3) {
+        uint32_t v = (unsigned char)in[i] << 16 | (unsigned char)in[i + 1] << 8 | (unsigned char)in[i + 2];
+        out += t[v >> 18]; out += t[(v >> 12) & 63]; out += t[(v >> 6) & 63]; out += t[v & 63];
+    }
+    if (i + 1 == in.size()) { uint32_t v = (unsigned char)in[i] << 16; out += t[v >> 18]; out += t[(v >> 12) & 63]; out += "=="; }
+    else if (i + 2 == in.size()) { uint32_t v = (unsigned char)in[i] << 16 | (unsigned char)in[i + 1] << 8; out += t[v >> 18]; out += t[(v >> 12) & 63]; out += t[(v >> 6) & 63]; out += '='; }
+    return out;
+}
+
+std::string header_value(const std::string& req, const std::string& name) {
+    std::istringstream ss(req); std::string line;
+    while (std::getline(ss, line)) {
+        auto colon = line.find(':'); if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        if (key.size() != name.size() || !std::equal(key.begin(), key.end(), name.begin(), [](char a, char b) { return std::tolower(a) == std::tolower(b); })) continue;
+        size_t b = line.find_first_not_of(' ', colon + 1), e = line.find_last_not_of("\r ");
+        return b == std::string::npos ? "" : line.substr(b, e - b + 1);
+    }
+    return "";
+}
+
+std::string ws_frame(uint8_t opcode, const std::string& payload) {
+    std::string f; f += (char)(0x80 | opcode);
+    if (payload.size() < 126) f += (char)payload.size();
+    else if (payload.size() < 65536) { f += (char)126; f += (char)(payload.size() >> 8); f += (char)(payload.size() & 0xff); }
+    else { f += (char)127; for (int i = 7; i >= 0; --i) f += (char)((uint64_t)payload.size() >> (8 * i)); }
+    return f + payload;
+}
+
+struct Client {
+    int fd; bool websocket = false, close_after = false; std::string in, out;
+    std::map<std::pair<uint32_t, int32_t>, MarketRecord> pending; // conflated (type, symbol) -> latest
+};
+
+void conflate(std::map<std::pair<uint32_t, int32_t>, MarketRecord>& pending, const MarketRecord& r) {
+    auto [it, fresh] = pending.try_emplace({(uint32_t)r.type, r.symbol}, r);
+    if (fresh) return;
+    MarketRecord sum = r;
+    if (r.type == RecordType::DATA) sum.v[1] += it->second.v[1];
+    else if (r.type == RecordType::SENTIMENT) for (int i = 0; i < 10; ++i) sum.v[i] += it->second.v[i];
+    it->second = sum;
+}
+
+volatile std::sig_atomic_t running = 1;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string shm, control = "http://localhost:8000", html_path = "templates/index.html"; int port = 8765;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto next = [&]() -> std::string { if (i + 1 >= argc) { std::cerr << "missing value for " << a << "\n"; std::exit(1); } return argv[++i]; };
+        if (a == "--shm") shm = next();
+        else if (a == "--port") port = std::stoi(next());
+        else if (a == "--control") control = next();
+        else if (a == "--html") html_path = next();
+        else { std::cerr << "unknown option " << a << "\n"; return 1; }
+    }
+    if (shm.empty()) { std::cerr << "usage: ws_gateway --shm <name> [--port N] [--control URL] [--html FILE]\n"; return 1; }
+
+    // Served page: the dashboard with the gateway switches injected ahead of its scripts.
+    std::ifstream hf(html_path); std::stringstream hs; hs << hf.rdbuf(); std::string html = hs.str();
+    if (html.empty()) { std::cerr << "cannot read " << html_path << "\n"; return 1; }
+    std::string inject = "<script>window.MARKET_WS = '/ws'; window.CONTROL_URL = '" + control + "';</script>\n";
+    size_t at = html.find("<script"); html.insert(at == std::string::npos ? 0 : at, inject);
+
+    std::signal(SIGINT, [](int) { running = 0; }); std::signal(SIGTERM, [](int) { running = 0; }); std::signal(SIGPIPE, SIG_IGN);
+    int lfd = socket(AF_INET, SOCK_STREAM, 0), one = 1; fcntl(lfd, F_SETFL, O_NONBLOCK);
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{}; addr.sin_family = AF_INET; addr.sin_port = htons(port); addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(lfd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(lfd, 64) != 0) { std::cerr << "cannot listen on port " << port << "\n"; return 1; }
+    std::cout << "Gateway on :" << port << ", waiting for ring " << shm << std::endl;
+
+    std::unique_ptr<MarketDataReader> reader;
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    uint64_t reattach_at = 0, loops = 0;
+
+    while (running) {
+        // (Re)attach to the ring; an engine restart unlinks and recreates it.
+        if (!reader && loops >= reattach_at) {
+            auto r = std::make_unique<MarketDataReader>();
+            if (r->attach(shm, true)) { reader = std::move(r); std::cout << "Attached to " << shm << std::endl; }
+            else reattach_at = loops + 100;
+        }
+        ++loops;
+
+        fds.clear(); fds.push_back({lfd, POLLIN, 0});
+        for (auto& c : clients) fds.push_back({c.fd, (short)(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0});
+        poll(fds.data(), fds.size(), 1);
+
+        if (fds[0].revents & POLLIN) {
+            int cfd; while ((cfd = accept(lfd, nullptr, nullptr)) >= 0) { fcntl(cfd, F_SETFL, O_NONBLOCK); setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); clients.push_back({cfd}); }
+        }
+
+        // Conflate new ring records into every websocket client's pending map
+        if (reader) {
+            MarketRecord r; int n = 0;
+            while (reader->poll(r)) { ++n; for (auto& c : clients) if (c.websocket) conflate(c.pending, r); }
+            if (n == 0 && loops % 1000 == 0) { int fd = shm_open(shm.c_str(), O_RDONLY, 0); if (fd < 0) reader.reset(); else ::close(fd); }
+        }
+
+        for (size_t i = 0; i < clients.size(); ++i) {
+            Client& c = clients[i]; short rev = fds.size() > i + 1 ? fds[i + 1].revents : 0; bool dead = rev & (POLLERR | POLLHUP);
+            if (rev & POLLIN) {
+                char buf[4096]; ssize_t k;
+                while ((k = recv(c.fd, buf, sizeof(buf), 0)) > 0) c.in.append(buf, k);
+                if (k == 0 || (k < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) dead = true;
+            }
+            if (!c.websocket && c.in.find("\r\n\r\n") != std::string::npos) {
+                std::string path = c.in.substr(c.in.find(' ') + 1); path = path.substr(0, path.find(' '));
+                std::string key = header_value(c.in, "Sec-WebSocket-Key");
+                if (path == "/ws" && !key.empty()) {
+                    std::string accept = base64(Sha1().digest(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+                    c.out += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " + accept + "\r\n\r\n";
+                    c.websocket = true;
+                } else if (path == "/" || path.rfind("/?", 0) == 0) {
+                    c.out += "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=utf-8\r\nContent-Length: " + std::to_string(html.size()) + "\r\nConnection: close\r\n\r\n" + html;
+                    c.close_after = true;
+                } else {
+                    c.out += "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                    c.close_after = true;
+                }
+                c.in.clear();
+            } else if (c.websocket && c.in.size() >= 2) {
+                // Browser -> gateway traffic is only control frames; honour close, answer ping.
+                uint8_t op = c.in[0] & 0x0f; size_t len = c.in[1] & 0x7f, hdr = 2 + 4;
+                if (len == 126) hdr += 2; else if (len == 127) hdr += 8;
+                if (op == 0x8) dead = true;
+                else if (c.in.size() >= hdr) {
+                    if (len == 126) len = (unsigned char)c.in[2] << 8 | (unsigned char)c.in[3];
+                    if (c.in.size() >= hdr + len) {
+                        std::string payload = c.in.substr(hdr, len);
+                        for (size_t j = 0; j < len; ++j) payload[j] ^= c.in[hdr - 4 + j % 4];
+                        if (op == 0x9) c.out += ws_frame(0xA, payload);
+                        c.in.erase(0, hdr + len);
+                    }
+                }
+            }
+            // Only build a new frame once the previous one is fully written
+            if (c.websocket && c.out.empty() && !c.pending.empty()) {
+                std::string payload(4, '\0'); uint32_t count = (uint32_t)c.pending.size(); std::memcpy(&payload[0], &count, 4);
+                for (auto& [k, r] : c.pending) payload.append((const char*)&r, sizeof(r));
+                c.pending.clear();
+                c.out = ws_frame(0x2, payload);
+            }
+            while (!c.out.empty() && !dead) {
+                ssize_t k = send(c.fd, c.out.data(), c.out.size(), 0);
+                if (k > 0) c.out.erase(0, k);
+                else { if (errno != EAGAIN && errno != EWOULDBLOCK) dead = true; break; }
+            }
+            if (c.close_after && c.out.empty()) dead = true; // plain HTTP response sent
+            if (dead) { ::close(c.fd); clients.erase(clients.begin() + i); if (i + 1 < fds.size()) fds.erase(fds.begin() + i + 1); --i; }
+        }
+    }
+    for (auto& c : clients) ::close(c.fd);
+    ::close(lfd);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#ifndef MARKETSIM_H
+#define MARKETSIM_H
+
+/* Stable C API for the very volatile market (make lib -> libmarketsim.so), for embedding
+ * the engine in other languages and backtesters with direct calls instead of sockets:
+ *
+ *     ms_config cfg = ms_default_config(); cfg.seed = 42; cfg.seeded = 1;
+ *     ms_sim* sim = ms_create(&cfg);
+ *     ms_on_fill(sim, on_fill, ctx);
+ *     ms_submit(sim, 1, 1, 101.0, 100);    // enters on the next tick
+ *     ms_step(sim, 1000);
+ *     ms_snapshot* s = ms_snapshot_take(sim);  ...  ms_snapshot_restore(sim, s);
+ *     ms_snapshot_free(s); ms_destroy(sim);
+ *
+ * Handles are opaque and not thread-safe; distinct handles may run on distinct threads.
+ * Calls return MS_OK or a negative status, with the reason in ms_last_error(). Callbacks
+ * run inside ms_step on the calling thread; they may query the handle and queue orders
+ * (which enter on the next tick) but not step or restore it. ms_destroy from a callback
+ * ends ms_step after the current tick and frees the handle as ms_step returns. Optional features
+ * (SIM_KERNEL, SIM_LATENCY, SIM_TIMELINE, ...) are read from the environment at ms_create. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define MS_API __declspec(dllexport)
+#else
+#define MS_API __attribute__((visibility("default")))
+#endif
+
+/* Bumped on any incompatible change to the functions or structs below */
+#define MS_API_VERSION 1
+
+enum { MS_OK = 0, MS_EINVAL = -1, MS_EBUSY = -2, MS_EINTERNAL = -3 };
+enum { MS_NORMAL = 0, MS_PUMP_DUMP = 1, MS_SHORT_SQUEEZE = 2 };
+/* Agent classes, in the order of ms_market_data's per-class arrays */
+enum { MS_FUNDAMENTAL = 0, MS_MOMENTUM = 1, MS_MAKER = 2, MS_NOISE = 3, MS_USER = 4, MS_NUM_CLASSES = 5 };
+
+typedef struct ms_sim ms_sim;
+typedef struct ms_snapshot ms_snapshot;
+
+typedef struct {
+    int32_t makers, fundamental, momentum, noise;
+    uint32_t seed; int32_t seeded; /* seeded == 0: seeds from SIM_SEED or std::random_device */
+} ms_config;
+
+/* Once per tick */
+typedef struct { double time, price; uint64_t volume; } ms_tick;
+
+/* Once per publish (every SIM_PUBLISH_EVERY ticks): the engines' throttled broadcast */
+typedef struct {
+    double time, price, true_value;
+    uint64_t volume;                            /* traded since the last publish */
+    double spread; int64_t liquidity;           /* top of book */
+    int64_t buy_volume[MS_NUM_CLASSES], sell_volume[MS_NUM_CLASSES]; /* since the last publish */
+    double class_pnl[MS_NUM_CLASSES];
+    double hype, bubble_ratio, panic; int64_t short_interest;
+} ms_market_data;
+
+typedef struct { uint32_t user; uint64_t order_id; int32_t is_buy; uint32_t quantity; double price; } ms_fill;
+
+typedef struct { int64_t position; double cash, realized, unrealized; uint32_t open_orders; } ms_account;
+typedef struct { uint64_t order_id; int32_t is_buy; double price; uint32_t remaining; } ms_open_order;
+
+typedef void (*ms_tick_fn)(void* ctx, const ms_tick* tick);
+typedef void (*ms_market_data_fn)(void* ctx, const ms_market_data* data);
+typedef void (*ms_fill_fn)(void* ctx, const ms_fill* fill);
+
+MS_API int ms_api_version(void);
+MS_API const char* ms_last_error(void);         /* per thread; valid until the next failing call */
+MS_API ms_config ms_default_config(void);       /* the engines' default population */
+
+MS_API ms_sim* ms_create(const ms_config* config); /* NULL on failure */
+MS_API void ms_destroy(ms_sim* sim);            /* from a callback: deferred until ms_step returns */
+
+MS_API int ms_step(ms_sim* sim, int64_t ticks);
+MS_API int ms_set_scenario(ms_sim* sim, int scenario);
+/* Queued limit order / cancel for a user account (created on first order) */
+MS_API int ms_submit(ms_sim* sim, uint32_t user, int is_buy, double price, int32_t quantity);
+MS_API int ms_cancel(ms_sim* sim, uint32_t user, uint64_t order_id);
+
+/* NULL fn unregisters; ctx is passed back untouched */
+MS_API int ms_on_tick(ms_sim* sim, ms_tick_fn fn, void* ctx);
+MS_API int ms_on_market_data(ms_sim* sim, ms_market_data_fn fn, void* ctx);
+MS_API int ms_on_fill(ms_sim* sim, ms_fill_fn fn, void* ctx);
+
+MS_API double ms_time(const ms_sim* sim);
+MS_API double ms_price(const ms_sim* sim);
+MS_API double ms_true_value(const ms_sim* sim);
+MS_API int64_t ms_ticks(const ms_sim* sim);
+/* Fills `out`, and up to `capacity` of the user's resting orders into `orders` (may be NULL) */
+MS_API int ms_get_account(ms_sim* sim, uint32_t user, ms_account* out, ms_open_order* orders, uint32_t capacity);
+
+/* Full engine state: book, agents, RNG streams, in-flight and queued orders. A restored
+ * handle continues exactly as the original did from the snapshot point. Callbacks are
+ * not part of the state. A snapshot can be restored into any handle, any number of times. */
+MS_API ms_snapshot* ms_snapshot_take(const ms_sim* sim); /* NULL on failure */
+MS_API int ms_snapshot_restore(ms_sim* sim, const ms_snapshot* snapshot);
+MS_API void ms_snapshot_free(ms_snapshot* snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -9,12 +9,15 @@ import subprocess
 import signal
 import os
 import sys
+import collections
 
 BINARIES = {
     "moderate": "./limit_order_book_moderate",
     "volatile": "./limit_order_book_volatile",
     "very_volatile": "./limit_order_book_very_volatile",
-    "most_volatile": "./limit_order_book_most_volatile"
+    "most_volatile": "./limit_order_book_most_volatile",
+    "multi": "./limit_order_book_multi",
+    "index_basket": "./limit_order_book_moderate"  # moderate engine in basket mode (START symbols > 1)
 }
 
 app = FastAPI()
@@ -26,6 +29,72 @@ current_process = None
 zmq_ctx = zmq.asyncio.Context()
 command_pub = None 
 
+# Users are identified by a browser-held key so a reload keeps the same engine account.
+# Engine user ids start at 1; 0 is the engine's default for ORDERs without a user field.
+user_ids = {}        # user_key -> engine user id
+sid_users = {}       # socket sid -> engine user id
+account_cache = {}   # (engine user id, symbol) -> last ACCOUNT snapshot (replayed on reconnect)
+
+# Per-client conflation: the listener only records the latest payload per key (event,
+# symbol) for each client, and each client's flush task sends them as one 'batch' at most
+# MAX_CLIENT_HZ times per second, waiting for the browser's ack before the next one. A slow
+# client therefore gets the freshest snapshot instead of a backlog, and the engine can
+# publish every tick (SIM_PUBLISH_EVERY=1). Fields the engine resets on every publish (DATA
+# volume, SENTIMENT class volumes) are summed over the skipped messages, not replaced.
+# User fills are queued rather than conflated, up to FILL_BACKLOG per client; past that the
+# oldest are dropped.
+MAX_CLIENT_HZ = float(os.environ.get('MAX_CLIENT_HZ', '20'))
+ACK_TIMEOUT = 5.0
+FILL_BACKLOG = 500
+
+def conflate(event, pending, payload):
+    if event == 'market_data': return dict(payload, volume=pending['volume'] + payload['volume'])
+    if event == 'server_sentiment': return [a + b for a, b in zip(pending, payload)]
+    return payload
+
+class ClientFeed:
+    def __init__(self, sid):
+        self.sid, self.uid, self.symbols, self.market = sid, None, {0}, True
+        self.latest = {}
+        self.fills = collections.deque(maxlen=FILL_BACKLOG)
+        self.wake, self.acked = asyncio.Event(), asyncio.Event()
+        self.task = asyncio.create_task(self.run())
+
+    def offer(self, key, event, payload):
+        pending = self.latest.get(key)
+        self.latest[key] = (event, conflate(event, pending[1], payload) if pending else payload); self.wake.set()
+
+    def offer_fill(self, payload):
+        self.fills.append(payload); self.wake.set()
+
+    async def run(self):
+        try:
+            while True:
+                await self.wake.wait(); self.wake.clear()
+                batch = [[event, payload] for event, payload in self.latest.values()] + [['trade_log', f] for f in self.fills]
+                self.latest = {}; self.fills.clear()
+                self.acked.clear()
+                await sio.emit('batch', batch, to=self.sid, callback=lambda *_: self.acked.set())
+                try: await asyncio.wait_for(self.acked.wait(), ACK_TIMEOUT)
+                except asyncio.TimeoutError: pass
+                await asyncio.sleep(1.0 / MAX_CLIENT_HZ)
+        except asyncio.CancelledError:
+            pass
+
+feeds = {}   # socket sid -> ClientFeed
+
+# Multi-symbol engines tag messages "S<n> ". Symbol 0 (and untagged messages) go to every
+# client; other symbols only to clients that asked for them via subscribe_symbol.
+def fan_out(event, sym, payload):
+    for feed in feeds.values():
+        if feed.market and sym in feed.symbols: feed.offer((event, sym), event, payload)
+
+def to_user(uid, event, sym, payload):
+    for feed in feeds.values():
+        if feed.uid != uid: continue
+        if event == 'trade_log': feed.offer_fill(payload)
+        else: feed.offer((event, sym), event, payload)
+
 async def zmq_data_listener():
     print("🎧 ZMQ Data Listener Active...")
     sub_sock = zmq_ctx.socket(zmq.SUB)
@@ -36,16 +105,19 @@ async def zmq_data_listener():
         try:
             msg = await sub_sock.recv_string()
             parts = msg.split(" ")
+            sym = 0
+            if parts[0].startswith("S") and parts[0][1:].isdigit():
+                sym = int(parts[0][1:]); parts = parts[1:]
             
             if parts[0] == "DATA":
-                await sio.emit('market_data', {'price': float(parts[1]), 'volume': int(parts[2])})
+                fan_out('market_data', sym, {'price': float(parts[1]), 'volume': int(parts[2]), 'symbol': sym, 'ts': int(parts[3]) if len(parts) > 3 else 0})
             elif parts[0] == "TRADE":
-                await sio.emit('trade_log', {'agent': parts[1], 'side': parts[2], 'qty': int(parts[3]), 'price': float(parts[4])})
+                fan_out('trade_log', sym, {'agent': parts[1], 'side': parts[2], 'qty': int(parts[3]), 'price': float(parts[4])})
             elif parts[0] == "SENTIMENT":
                 data = [int(x) for x in parts[1:]]
-                await sio.emit('server_sentiment', data)
+                fan_out('server_sentiment', sym, data)
             elif parts[0] == "SCENARIO_METRICS":
-                await sio.emit('scenario_metrics', {
+                fan_out('scenario_metrics', sym, {
                     'hype': float(parts[1]),
                     'bubble': float(parts[2]),
                     'short_interest': int(parts[3]),
@@ -53,7 +125,20 @@ async def zmq_data_listener():
                 })
             # ADDED: Handler for General Metrics
             elif parts[0] == "METRICS":
-                await sio.emit('market_metrics', {'spread': float(parts[1]), 'liquidity': int(parts[2])})
+                fan_out('market_metrics', sym, {'spread': float(parts[1]), 'liquidity': int(parts[2])})
+            elif parts[0] == "FILL":
+                uid = int(parts[1])
+                to_user(uid, 'trade_log', sym, {'agent': 'USER', 'side': parts[2], 'qty': int(parts[3]), 'price': float(parts[4]), 'order_id': int(parts[5]), 'symbol': sym})
+            elif parts[0] == "ACCOUNT":
+                uid, n = int(parts[1]), int(parts[6])
+                orders = [{'id': int(parts[7 + 4*i]), 'side': parts[8 + 4*i], 'price': float(parts[9 + 4*i]), 'remaining': int(parts[10 + 4*i])} for i in range(n)]
+                account = {'position': int(parts[2]), 'cash': float(parts[3]), 'realized': float(parts[4]), 'unrealized': float(parts[5]), 'orders': orders, 'symbol': sym}
+                account_cache[(uid, sym)] = account
+                to_user(uid, 'account_update', sym, account)
+            elif parts[0] == "PNL":
+                n = int(parts[6])
+                leaders = [{'account': int(parts[7 + 3*i]), 'class': int(parts[8 + 3*i]), 'pnl': float(parts[9 + 3*i])} for i in range(n)]
+                fan_out('agent_pnl', sym, {'classes': [float(x) for x in parts[1:6]], 'leaders': leaders})
                 
         except asyncio.CancelledError:
             break
@@ -91,6 +176,32 @@ def kill_current_simulation():
             pass
         current_process = None
 
+@sio.on('hello')
+async def hello(sid, data):
+    key = str(data.get('user_key', sid))
+    uid = user_ids.setdefault(key, len(user_ids) + 1)
+    sid_users[sid] = uid
+    feed = feeds.get(sid)
+    if not feed: return
+    feed.uid = uid
+    feed.market = data.get('market_data', True)  # False when market data comes from ws_gateway
+    for (cached_uid, sym), account in account_cache.items():
+        if cached_uid == uid: feed.offer(('account_update', sym), 'account_update', account)
+
+@sio.on('subscribe_symbol')
+async def subscribe_symbol(sid, data):
+    if sid in feeds: feeds[sid].symbols.add(int(data.get('symbol', 0)))
+
+@sio.event
+async def connect(sid, environ):
+    feeds[sid] = ClientFeed(sid)
+
+@sio.event
+async def disconnect(sid):
+    sid_users.pop(sid, None)
+    feed = feeds.pop(sid, None)
+    if feed: feed.task.cancel()
+
 @sio.on('start_simulation')
 async def start_simulation(sid, data):
     global current_process
@@ -103,11 +214,12 @@ async def start_simulation(sid, data):
         await sio.emit('error', {'message': f"Binary {binary_path} not found."}, room=sid)
         return
 
+    account_cache.clear()
     print(f"🚀 Launching {mode}...")
     try:
         current_process = subprocess.Popen([binary_path], stdout=sys.stdout, stderr=sys.stderr)
         await asyncio.sleep(0.5)
-        config_str = f"START {data['makers']} {data['fundamental']} {data['momentum']} {data['noise']}"
+        config_str = f"START {data['makers']} {data['fundamental']} {data['momentum']} {data['noise']} {int(data.get('symbols', 1))}"
         await async_send_command(config_str)
     except Exception as e:
         await sio.emit('error', {'message': str(e)}, room=sid)
@@ -126,10 +238,22 @@ async def stop_simulation(sid):
 
 @sio.on('place_order')
 async def place_order(sid, data):
+    uid = sid_users.get(sid)
+    if uid is None:
+        await sio.emit('error', {'message': "Order rejected: send 'hello' first."}, room=sid)
+        return
     side_int = 0 if data['side'] == 'buy' else 1
-    cmd = f"ORDER {side_int} {int(data['quantity'])} {float(data['price'])}"
+    cmd = f"ORDER {side_int} {int(data['quantity'])} {float(data['price'])} {uid} {int(data.get('symbol', 0))}"
     await async_send_command(cmd)
 
+@sio.on('cancel_order')
+async def cancel_order(sid, data):
+    uid = sid_users.get(sid)
+    if uid is None:
+        await sio.emit('error', {'message': "Cancel rejected: send 'hello' first."}, room=sid)
+        return
+    await async_send_command(f"CANCEL {uid} {int(data['id'])}")
+
 @sio.on('set_scenario')
 async def set_scenario(sid, data):
     scenario_map = {'normal': 0, 'pump': 1, 'squeeze': 2}